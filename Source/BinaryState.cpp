@@ -0,0 +1,244 @@
+#include "BinaryState.h"
+
+namespace
+{
+    // Little-endian whatever the platform, so states move between machines
+    juce::uint32 readUInt32 (const juce::uint8* source) noexcept
+    {
+        return (juce::uint32) source[0] | ((juce::uint32) source[1] << 8) | ((juce::uint32) source[2] << 16) | ((juce::uint32) source[3] << 24);
+    }
+
+    juce::uint16 readUInt16 (const juce::uint8* source) noexcept
+    {
+        return (juce::uint16) (source[0] | (source[1] << 8));
+    }
+
+    void writeUInt32 (juce::uint8* dest, juce::uint32 value) noexcept
+    {
+        for (int i = 0; i < 4; ++i)
+            dest[i] = (juce::uint8) (value >> (8 * i));
+    }
+
+    void writeUInt16 (juce::uint8* dest, juce::uint16 value) noexcept
+    {
+        dest[0] = (juce::uint8) value;
+        dest[1] = (juce::uint8) (value >> 8);
+    }
+
+    /** The reflected CRC-32 lookup table, one entry per byte value. */
+    struct CRCTable
+    {
+        CRCTable() noexcept
+        {
+            for (juce::uint32 i = 0; i < 256; ++i)
+            {
+                auto c = i;
+
+                for (int bit = 0; bit < 8; ++bit)
+                    c = (c & 1) != 0 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+
+                entries[i] = c;
+            }
+        }
+
+        juce::uint32 entries[256];
+    };
+}
+
+//==============================================================================
+BinaryState::BinaryState (const juce::Array<juce::AudioProcessorParameter*>& parametersToStore)
+{
+    // The entry count is a uint16
+    jassert (parametersToStore.size() <= 0xffff);
+
+    slots.reserve ((size_t) parametersToStore.size());
+
+    for (auto* param : parametersToStore)
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (param);
+        jassert (ranged != nullptr);
+
+        if (ranged != nullptr)
+            slots.push_back ({ hashParameterID (ranged->getParameterID()), ranged, slots.size() });
+    }
+
+    slotsByHash = slots;
+    std::sort (slotsByHash.begin(), slotsByHash.end(), [] (const Slot& a, const Slot& b) { return a.idHash < b.idHash; });
+
+    // Two IDs with the same hash couldn't be told apart in a state; rename one of them
+    jassert (std::adjacent_find (slotsByHash.begin(), slotsByHash.end(),
+                                 [] (const Slot& a, const Slot& b) { return a.idHash == b.idHash; }) == slotsByHash.end());
+}
+
+void BinaryState::save (juce::MemoryBlock& dest) const
+{
+    const auto numEntries = slots.size();
+    const auto totalSize  = headerSize + numEntries * entrySize + crcSize;
+
+    dest.setSize (totalSize);
+    auto* bytes = static_cast<juce::uint8*> (dest.getData());
+
+    writeUInt32 (bytes, magic);
+    writeUInt16 (bytes + 4, currentVersion);
+    writeUInt16 (bytes + 6, (juce::uint16) numEntries);
+
+    auto* entry = bytes + headerSize;
+
+    for (const auto& slot : slots)
+    {
+        const auto value = slot.parameter->convertFrom0to1 (slot.parameter->getValue());
+
+        juce::uint32 valueBits;
+        std::memcpy (&valueBits, &value, sizeof (valueBits));
+
+        writeUInt32 (entry, slot.idHash);
+        writeUInt32 (entry + 4, valueBits);
+        entry += entrySize;
+    }
+
+    writeUInt32 (entry, crc32 (bytes, totalSize - crcSize));
+}
+
+bool BinaryState::load (const void* data, size_t sizeInBytes) const
+{
+    const auto checkedEntries = checkState (data, sizeInBytes);
+
+    if (checkedEntries < 0)
+        return false;
+
+    const auto numEntries = (size_t) checkedEntries;
+    const auto* entries   = static_cast<const juce::uint8*> (data) + headerSize;
+
+    auto setFromEntry = [entries] (const Slot& slot, size_t i)
+    {
+        setValue (*slot.parameter, slot.parameter->convertTo0to1 (readValue (entries + i * entrySize + 4)));
+    };
+
+    // Saved by this layout: entry i is parameter i
+    bool sameLayout = numEntries == slots.size();
+
+    for (size_t i = 0; i < numEntries && sameLayout; ++i)
+        sameLayout = readUInt32 (entries + i * entrySize) == slots[i].idHash;
+
+    if (sameLayout)
+    {
+        for (size_t i = 0; i < numEntries; ++i)
+            setFromEntry (slots[i], i);
+
+        return true;
+    }
+
+    // Any other parameter set: match by ID, and reset whatever the state leaves out
+    std::vector<bool> restored (slots.size(), false);
+
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        if (const auto* match = findSlot (readUInt32 (entries + i * entrySize)))
+        {
+            setFromEntry (*match, i);
+            restored[match->position] = true;
+        }
+    }
+
+    for (const auto& slot : slots)
+        if (! restored[slot.position])
+            setValue (*slot.parameter, slot.parameter->getDefaultValue());
+
+    return true;
+}
+
+bool BinaryState::isBinaryState (const void* data, size_t sizeInBytes) noexcept
+{
+    return data != nullptr && sizeInBytes >= 4 && readUInt32 (static_cast<const juce::uint8*> (data)) == magic;
+}
+
+//==============================================================================
+bool BinaryState::locateValues (const void* data, size_t sizeInBytes, juce::uint32* valueOffsets) const
+{
+    const auto numEntries = checkState (data, sizeInBytes);
+
+    if (numEntries < 0)
+        return false;
+
+    std::fill (valueOffsets, valueOffsets + slots.size(), 0u);
+
+    const auto* entries = static_cast<const juce::uint8*> (data) + headerSize;
+
+    for (size_t i = 0; i < (size_t) numEntries; ++i)
+        if (const auto* match = findSlot (readUInt32 (entries + i * entrySize)))
+            valueOffsets[match->position] = (juce::uint32) (headerSize + i * entrySize + 4);
+
+    return true;
+}
+
+float BinaryState::readValue (const void* valueData) noexcept
+{
+    const auto valueBits = readUInt32 (static_cast<const juce::uint8*> (valueData));
+
+    float value;
+    std::memcpy (&value, &valueBits, sizeof (value));
+    return value;
+}
+
+int BinaryState::checkState (const void* data, size_t sizeInBytes) noexcept
+{
+    if (! isBinaryState (data, sizeInBytes) || sizeInBytes < headerSize + crcSize)
+        return -1;
+
+    const auto* bytes = static_cast<const juce::uint8*> (data);
+    const auto version    = readUInt16 (bytes + 4);
+    const auto numEntries = (size_t) readUInt16 (bytes + 6);
+
+    // A newer version may mean something else by its entries
+    if (version == 0 || version > currentVersion)
+        return -1;
+
+    if (sizeInBytes != headerSize + numEntries * entrySize + crcSize
+         || readUInt32 (bytes + sizeInBytes - crcSize) != crc32 (bytes, sizeInBytes - crcSize))
+        return -1;
+
+    return (int) numEntries;
+}
+
+const BinaryState::Slot* BinaryState::findSlot (juce::uint32 idHash) const noexcept
+{
+    const auto match = std::lower_bound (slotsByHash.begin(), slotsByHash.end(), idHash,
+                                         [] (const Slot& slot, juce::uint32 hash) { return slot.idHash < hash; });
+
+    return match != slotsByHash.end() && match->idHash == idHash ? &*match : nullptr;
+}
+
+//==============================================================================
+juce::uint32 BinaryState::crc32 (const void* data, size_t sizeInBytes) noexcept
+{
+    static const CRCTable table;
+
+    const auto* bytes = static_cast<const juce::uint8*> (data);
+    juce::uint32 crc = 0xffffffffu;
+
+    for (size_t i = 0; i < sizeInBytes; ++i)
+        crc = table.entries[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+
+    return crc ^ 0xffffffffu;
+}
+
+juce::uint32 BinaryState::hashParameterID (const juce::String& parameterID) noexcept
+{
+    juce::uint32 hash = 0x811c9dc5u;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+    {
+        hash ^= (juce::uint8) *c;
+        hash *= 0x01000193u;
+    }
+
+    return hash;
+}
+
+//==============================================================================
+void BinaryState::setValue (juce::RangedAudioParameter& parameter, float normalisedValue)
+{
+    // Hosts recall snapshots constantly; parameters that don't change are left alone, listeners and host included
+    if (normalisedValue != parameter.getValue())
+        parameter.setValueNotifyingHost (normalisedValue);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The plugin's saved state: every parameter's value in a small fixed-layout
+    binary block, written and read straight from the parameters without going
+    through a ValueTree or XML.
+
+    Layout, all little-endian:
+
+        offset  size     contents
+        0       4        magic, "SEQB"
+        4       2        format version (currentVersion)
+        6       2        number of entries, n
+        8       8 n      entries: the parameter ID's FNV-1a hash (uint32) and
+                         its plain, denormalised value (float)
+        8 + 8 n 4        CRC-32 of everything before it
+
+    Entries are written in parameter order. A state saved by the same build
+    lines up entry for entry, so loading it is a single pass. A state with a
+    different parameter set is matched by ID hash instead: parameters it
+    doesn't mention go back to their defaults, and entries for unknown IDs are
+    skipped, as with the XML states. Plain values keep their meaning if a
+    parameter's range changes later.
+
+    A state that is truncated, fails its CRC or comes from a newer version is
+    rejected as a whole and changes nothing. Loading only allocates when the
+    state's layout doesn't match this build's.
+*/
+class BinaryState
+{
+public:
+    //==============================================================================
+    static constexpr juce::uint16 currentVersion = 1;
+
+    /** Takes the parameters to save and restore. All of them must be RangedAudioParameters with distinct IDs. */
+    explicit BinaryState (const juce::Array<juce::AudioProcessorParameter*>& parametersToStore);
+
+    /** Replaces dest with the current parameter values. */
+    void save (juce::MemoryBlock& dest) const;
+
+    /**
+        Sets every parameter from a saved state, notifying the host of each
+        one that changes. Returns false, and changes nothing, if the state is
+        damaged or from a newer version.
+    */
+    bool load (const void* data, size_t sizeInBytes) const;
+
+    /** True if data starts like a binary state, whatever its version; XML states never do. */
+    static bool isBinaryState (const void* data, size_t sizeInBytes) noexcept;
+
+    //==============================================================================
+    /**
+        Finds each parameter's value in a saved state without applying it:
+        valueOffsets[i] becomes the byte offset of parameter i's value from
+        data, or 0 if the state doesn't store it. Returns false, and fills
+        nothing, if the state would be rejected by load(). readValue() decodes
+        a value found this way.
+    */
+    bool locateValues (const void* data, size_t sizeInBytes, juce::uint32* valueOffsets) const;
+
+    static float readValue (const void* valueData) noexcept;
+
+    /** The parameters, in the order they're saved. */
+    size_t getNumParameters() const noexcept                                { return slots.size(); }
+    juce::RangedAudioParameter& getParameter (size_t index) const noexcept  { return *slots[index].parameter; }
+
+    //==============================================================================
+    /** CRC-32 (IEEE 802.3, as used by zlib and PNG). */
+    static juce::uint32 crc32 (const void* data, size_t sizeInBytes) noexcept;
+
+    /** FNV-1a over the ID's UTF-8 bytes. */
+    static juce::uint32 hashParameterID (const juce::String& parameterID) noexcept;
+
+private:
+    //==============================================================================
+    static constexpr juce::uint32 magic     = 0x42514553;     // "SEQB" as a little-endian uint32
+    static constexpr size_t headerSize      = 8;
+    static constexpr size_t entrySize       = 8;
+    static constexpr size_t crcSize         = 4;
+
+    struct Slot
+    {
+        juce::uint32 idHash;
+        juce::RangedAudioParameter* parameter;
+        size_t position;                // in slots
+    };
+
+    // The number of entries in a state load() would accept, or -1
+    static int checkState (const void* data, size_t sizeInBytes) noexcept;
+
+    const Slot* findSlot (juce::uint32 idHash) const noexcept;
+    static void setValue (juce::RangedAudioParameter& parameter, float normalisedValue);
+
+    std::vector<Slot> slots;            // parameter order, as written
+    std::vector<Slot> slotsByHash;      // sorted by hash, for states with another layout
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinaryState)
+};
@@ -0,0 +1,653 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCoefficients.h"
+
+//==============================================================================
+/**
+    A cascade of up to MaxBands biquads that runs every enabled band in a single
+    pass over the buffer, for up to MaxChannels channels.
+
+    The channels are split into groups of one SIMDRegister's width (4 floats or
+    2 doubles with SSE / NEON, 8 floats with AVX), and each group is filtered
+    with one vector multiply-add chain per band per sample instead of one scalar
+    pass per band per channel. A stereo buffer is a single group; a 7.1.4 bed is
+    three groups of four float channels.
+
+    Each band is a transposed direct form II section using exactly the same
+    update order as juce::dsp::IIR::Filter, so the output matches a
+    ProcessorChain of IIR filters with the same coefficients to within float
+    rounding (max. absolute difference below 1e-5 for full-scale input).
+
+    Coefficients are stored per band and per channel, so a band can be linked
+    across all channels or apply to some of them only. Channels a band leaves
+    alone get identity coefficients, and a band whose lanes are all identity in
+    a group is left out of that group's active list, so it costs nothing there.
+    The same goes for disabled bands. The SIMD kernel is instantiated once per
+    active band count, which keeps its per-sample band loop fully unrolled
+    whatever the count is.
+
+    The kernel is picked in prepare(): the SIMD one whenever the build has a
+    native SIMDRegister and there is more than one channel, otherwise a plain
+    scalar loop.
+
+    Coefficients can also be ramped: setTargetCoefficients() followed by
+    startRamp() moves every band linearly from its current coefficients to its
+    target over the next N samples, one step per sample. Each step lies on the
+    segment between two stable sections, and the stability triangle of
+    (a1, a2) is convex, so every intermediate section is stable too. While a
+    ramp runs, a second instantiation of the kernel adds the per-sample steps;
+    once it ends, the plain kernel takes over again.
+*/
+template <typename SampleType, size_t MaxBands, size_t MaxChannels = 16>
+class BiquadCascade
+{
+public:
+    using Coefficients = BiquadCoefficients<SampleType>;
+
+   #if JUCE_USE_SIMD
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr size_t numLanes       = Vec::SIMDNumElements;
+    static constexpr size_t stateAlignment = Vec::SIMDRegisterSize;
+   #else
+    static constexpr size_t numLanes       = 2;
+    static constexpr size_t stateAlignment = alignof (SampleType);
+   #endif
+
+    static constexpr size_t maxChannels = MaxChannels;
+    static constexpr size_t maxGroups   = (MaxChannels + numLanes - 1) / numLanes;
+
+    static_assert (maxGroups <= 32, "the per-band group mask is 32 bits");
+
+    enum class Kernel { scalar, simd };
+
+    //==============================================================================
+    BiquadCascade()
+    {
+        for (auto& band : bands)
+            band.setAll (Coefficients());
+    }
+
+    void prepare (const juce::dsp::ProcessSpec& spec)
+    {
+        numChannels = juce::jmin ((size_t) spec.numChannels, maxChannels);
+        jassert (spec.numChannels <= maxChannels);
+
+        kernel = chooseKernel();
+        reset();
+        updateActiveBands();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& band : bands)
+        {
+            std::fill (std::begin (band.s1), std::end (band.s1), SampleType());
+            std::fill (std::begin (band.s2), std::end (band.s2), SampleType());
+        }
+    }
+
+    /**
+        Replaces one band's coefficients on every channel, cancelling any ramp
+        the band was in. Filter state is kept, so this is safe mid-stream.
+    */
+    void setCoefficients (size_t bandIndex, const Coefficients& newCoefficients) noexcept
+    {
+        jassert (bandIndex < MaxBands);
+        bands[bandIndex].setAll (newCoefficients);
+        updateBandGroups (bandIndex);
+    }
+
+    /** Replaces one band's coefficients on one channel only. */
+    void setCoefficients (size_t bandIndex, size_t channel, const Coefficients& newCoefficients) noexcept
+    {
+        jassert (bandIndex < MaxBands && channel < maxChannels);
+        bands[bandIndex].set (channel, newCoefficients);
+        updateBandGroups (bandIndex);
+    }
+
+    /** The coefficients the band is running with right now, part-way through any ramp. */
+    Coefficients getCoefficients (size_t bandIndex, size_t channel = 0) const noexcept
+    {
+        return bands[bandIndex].get (channel);
+    }
+
+    //==============================================================================
+    /**
+        Sets the coefficients one band ramps to on every channel. Nothing moves
+        until startRamp() is called.
+    */
+    void setTargetCoefficients (size_t bandIndex, const Coefficients& newTarget) noexcept
+    {
+        jassert (bandIndex < MaxBands);
+        bands[bandIndex].setAllTargets (newTarget);
+        updateBandGroups (bandIndex);
+    }
+
+    /** Sets the coefficients one band ramps to on one channel only. */
+    void setTargetCoefficients (size_t bandIndex, size_t channel, const Coefficients& newTarget) noexcept
+    {
+        jassert (bandIndex < MaxBands && channel < maxChannels);
+        bands[bandIndex].setTarget (channel, newTarget);
+        updateBandGroups (bandIndex);
+    }
+
+    /**
+        Starts moving every band towards its target, reaching it after exactly
+        numSamples processed samples. A ramp that was still running continues
+        from wherever it got to.
+    */
+    void startRamp (size_t numSamples) noexcept
+    {
+        rampRemaining = numSamples;
+
+        if (numSamples == 0)
+            finishRamp();
+    }
+
+    bool isRamping() const noexcept     { return rampRemaining > 0; }
+
+    /**
+        Enables or disables a band. A band that gets enabled starts from a clean
+        state; bands are always processed in index order.
+    */
+    void setBandEnabled (size_t bandIndex, bool shouldBeEnabled) noexcept
+    {
+        jassert (bandIndex < MaxBands);
+
+        if (enabled[bandIndex] == shouldBeEnabled)
+            return;
+
+        enabled[bandIndex] = shouldBeEnabled;
+
+        if (shouldBeEnabled)
+            bands[bandIndex].clearState();
+
+        updateActiveBands();
+    }
+
+    bool isBandEnabled (size_t bandIndex) const noexcept    { return enabled[bandIndex]; }
+
+    /** The number of bands that run on at least one channel group. */
+    size_t getNumActiveBands() const noexcept
+    {
+        size_t count = 0;
+
+        for (size_t b = 0; b < MaxBands; ++b)
+            if (enabled[b] && bands[b].groupMask != 0)
+                ++count;
+
+        return count;
+    }
+
+    /**
+        The largest magnitude in any running band's state, e.g. to tell when the
+        cascade has rung out after its input went silent.
+    */
+    SampleType getStateMagnitude() const noexcept
+    {
+        SampleType magnitude {};
+
+        for (size_t group = 0; group * numLanes < numChannels; ++group)
+        {
+            const auto firstChannel = group * numLanes;
+            const auto lastChannel  = juce::jmin (numChannels, firstChannel + numLanes);
+
+            for (size_t k = 0; k < numActiveBands[group]; ++k)
+            {
+                const auto& band = bands[activeBands[group][k]];
+
+                for (size_t ch = firstChannel; ch < lastChannel; ++ch)
+                    magnitude = juce::jmax (magnitude, std::abs (band.s1[ch]), std::abs (band.s2[ch]));
+            }
+        }
+
+        return magnitude;
+    }
+
+    //==============================================================================
+    /** Forces a particular kernel, e.g. to compare them in a benchmark. */
+    void setKernel (Kernel newKernel) noexcept
+    {
+        kernel = (newKernel == Kernel::simd && ! canUseSIMD()) ? Kernel::scalar : newKernel;
+    }
+
+    Kernel getKernel() const noexcept   { return kernel; }
+
+    //==============================================================================
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+    {
+        auto& block = context.getOutputBlock();
+        jassert (block.getNumChannels() <= numChannels);
+
+        const auto channels = juce::jmin (block.getNumChannels(), numChannels);
+        const auto n        = block.getNumSamples();
+
+        if (context.isBypassed || n == 0)
+            return;
+
+        // The ramping part first, so the rest of the block runs on the exact targets
+        const auto rampLength = juce::jmin (n, rampRemaining);
+
+        if (rampLength > 0)
+        {
+            processGroups (block, channels, 0, rampLength, true);
+            rampRemaining -= rampLength;
+
+            if (rampRemaining == 0)
+                finishRamp();
+        }
+
+        if (rampLength < n)
+            processGroups (block, channels, rampLength, n - rampLength, false);
+
+        if (groupsToPrune)
+            pruneRampedOutGroups();
+    }
+
+private:
+    //==============================================================================
+    static constexpr size_t paddedChannels = maxGroups * numLanes;
+
+    /** Per-channel coefficients, ramp targets and state, laid out so one group loads straight into a register. */
+    struct alignas (stateAlignment) BandData
+    {
+        SampleType b0[paddedChannels], b1[paddedChannels], b2[paddedChannels],
+                   a1[paddedChannels], a2[paddedChannels];
+        SampleType tb0[paddedChannels], tb1[paddedChannels], tb2[paddedChannels],
+                   ta1[paddedChannels], ta2[paddedChannels];
+        SampleType s1[paddedChannels] = {};
+        SampleType s2[paddedChannels] = {};
+
+        juce::uint32 groupMask = 0;         // bit g set: group g has at least one non-identity lane, now or after the ramp
+
+        void set (size_t ch, const Coefficients& c) noexcept
+        {
+            setCurrent (ch, c);
+            setTarget (ch, c);
+        }
+
+        void setCurrent (size_t ch, const Coefficients& c) noexcept
+        {
+            b0[ch] = c.b0;  b1[ch] = c.b1;  b2[ch] = c.b2;
+            a1[ch] = c.a1;  a2[ch] = c.a2;
+        }
+
+        void setTarget (size_t ch, const Coefficients& c) noexcept
+        {
+            tb0[ch] = c.b0;  tb1[ch] = c.b1;  tb2[ch] = c.b2;
+            ta1[ch] = c.a1;  ta2[ch] = c.a2;
+        }
+
+        void setAll (const Coefficients& c) noexcept
+        {
+            for (size_t ch = 0; ch < paddedChannels; ++ch)
+                set (ch, c);
+        }
+
+        void setAllTargets (const Coefficients& c) noexcept
+        {
+            for (size_t ch = 0; ch < paddedChannels; ++ch)
+                setTarget (ch, c);
+        }
+
+        void jumpToTargets() noexcept
+        {
+            std::copy (std::begin (tb0), std::end (tb0), b0);
+            std::copy (std::begin (tb1), std::end (tb1), b1);
+            std::copy (std::begin (tb2), std::end (tb2), b2);
+            std::copy (std::begin (ta1), std::end (ta1), a1);
+            std::copy (std::begin (ta2), std::end (ta2), a2);
+        }
+
+        Coefficients get (size_t ch) const noexcept     { return { b0[ch], b1[ch], b2[ch], a1[ch], a2[ch] }; }
+
+        // True if the lane passes its input straight through, both now and at the end of the ramp
+        bool isIdentity (size_t ch) const noexcept
+        {
+            return b0[ch] == SampleType (1) && b1[ch] == SampleType() && b2[ch] == SampleType()
+                && a1[ch] == SampleType() && a2[ch] == SampleType()
+                && tb0[ch] == SampleType (1) && tb1[ch] == SampleType() && tb2[ch] == SampleType()
+                && ta1[ch] == SampleType() && ta2[ch] == SampleType();
+        }
+
+        void clearState() noexcept
+        {
+            std::fill (std::begin (s1), std::end (s1), SampleType());
+            std::fill (std::begin (s2), std::end (s2), SampleType());
+        }
+    };
+
+    std::array<BandData, MaxBands> bands;
+    std::array<bool, MaxBands>     enabled {};
+
+    // Indices of the bands each group runs, in processing order
+    std::array<std::array<size_t, MaxBands>, maxGroups> activeBands {};
+    std::array<size_t, maxGroups> numActiveBands {};
+
+    size_t numChannels   = 0;
+    size_t rampRemaining = 0;       // samples left until every band reaches its target
+    bool   groupsToPrune = false;   // a band may have ramped out of a group it still has state in
+    Kernel kernel        = Kernel::scalar;
+
+    //==============================================================================
+    static juce::uint32 getGroupMask (const BandData& band) noexcept
+    {
+        juce::uint32 mask = 0;
+
+        for (size_t group = 0; group < maxGroups; ++group)
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                if (! band.isIdentity (group * numLanes + lane))
+                    mask |= 1u << group;
+
+        return mask;
+    }
+
+    /** Re-checks which groups a band touches, and rebuilds the active lists if that changed. */
+    void updateBandGroups (size_t bandIndex) noexcept
+    {
+        auto& band = bands[bandIndex];
+        const auto mask = getGroupMask (band);
+
+        if (mask == band.groupMask)
+            return;
+
+        // A group the band starts running on has a stale (or no) history there
+        for (size_t group = 0; group < maxGroups; ++group)
+        {
+            if ((mask & ~band.groupMask) & (1u << group))
+            {
+                std::fill_n (band.s1 + group * numLanes, numLanes, SampleType());
+                std::fill_n (band.s2 + group * numLanes, numLanes, SampleType());
+            }
+        }
+
+        band.groupMask = mask;
+        updateActiveBands();
+    }
+
+    void updateActiveBands() noexcept
+    {
+        for (size_t group = 0; group < maxGroups; ++group)
+        {
+            numActiveBands[group] = 0;
+
+            for (size_t b = 0; b < MaxBands; ++b)
+                if (enabled[b] && (bands[b].groupMask & (1u << group)) != 0)
+                    activeBands[group][numActiveBands[group]++] = b;
+        }
+    }
+
+    /** Lands every band exactly on its target. */
+    void finishRamp() noexcept
+    {
+        rampRemaining = 0;
+
+        for (auto& band : bands)
+            band.jumpToTargets();
+
+        groupsToPrune = true;
+    }
+
+    /**
+        Drops the groups a band has ramped out of. A lane that has just become
+        identity still has up to two samples of state to play out, so a group
+        is only dropped once its state is zero.
+    */
+    void pruneRampedOutGroups() noexcept
+    {
+        groupsToPrune = false;
+        bool anyDropped = false;
+
+        for (auto& band : bands)
+        {
+            auto mask = getGroupMask (band);
+
+            for (size_t group = 0; group < maxGroups; ++group)
+            {
+                if ((band.groupMask & ~mask & (1u << group)) == 0)
+                    continue;
+
+                const auto* s1 = band.s1 + group * numLanes;
+                const auto* s2 = band.s2 + group * numLanes;
+
+                if (std::any_of (s1, s1 + numLanes, [] (SampleType s) { return s != SampleType(); })
+                     || std::any_of (s2, s2 + numLanes, [] (SampleType s) { return s != SampleType(); }))
+                {
+                    mask |= 1u << group;
+                    groupsToPrune = true;
+                }
+            }
+
+            if (mask != band.groupMask)
+            {
+                band.groupMask = mask;
+                anyDropped = true;
+            }
+        }
+
+        if (anyDropped)
+            updateActiveBands();
+    }
+
+    bool canUseSIMD() const noexcept
+    {
+       #if JUCE_USE_SIMD
+        return numChannels > 1;
+       #else
+        return false;
+       #endif
+    }
+
+    Kernel chooseKernel() const noexcept
+    {
+        return canUseSIMD() ? Kernel::simd : Kernel::scalar;
+    }
+
+    //==============================================================================
+    void processGroups (juce::dsp::AudioBlock<SampleType>& block, size_t channels,
+                        size_t startSample, size_t numSamples, bool ramping) noexcept
+    {
+        for (size_t group = 0; group * numLanes < channels; ++group)
+        {
+            const auto numActive = numActiveBands[group];
+
+            if (numActive == 0)
+                continue;
+
+            const auto firstChannel    = group * numLanes;
+            const auto channelsInGroup = juce::jmin (numLanes, channels - firstChannel);
+
+            SampleType* channelData[numLanes] = {};
+
+            for (size_t ch = 0; ch < channelsInGroup; ++ch)
+                channelData[ch] = block.getChannelPointer (firstChannel + ch) + startSample;
+
+           #if JUCE_USE_SIMD
+            if (kernel == Kernel::simd)
+                (this->*getSIMDKernel (numActive, ramping)) (channelData, channelsInGroup, numSamples, group);
+            else
+           #endif
+            if (ramping)
+                processScalar<true> (channelData, channelsInGroup, numSamples, group);
+            else
+                processScalar<false> (channelData, channelsInGroup, numSamples, group);
+
+            snapStateToZero (group);
+        }
+    }
+
+    template <bool Ramp>
+    void processScalar (SampleType* const* channelData, size_t channels, size_t numSamples, size_t group) noexcept
+    {
+        for (size_t lane = 0; lane < channels; ++lane)
+        {
+            auto* data = channelData[lane];
+            const auto ch = group * numLanes + lane;
+
+            for (size_t k = 0; k < numActiveBands[group]; ++k)
+            {
+                auto& band = bands[activeBands[group][k]];
+                auto c = band.get (ch);
+                auto s1 = band.s1[ch];
+                auto s2 = band.s2[ch];
+
+                Coefficients step;
+
+                if constexpr (Ramp)
+                {
+                    const auto scale = SampleType (1) / (SampleType) rampRemaining;
+                    step = { (band.tb0[ch] - c.b0) * scale, (band.tb1[ch] - c.b1) * scale, (band.tb2[ch] - c.b2) * scale,
+                             (band.ta1[ch] - c.a1) * scale, (band.ta2[ch] - c.a2) * scale };
+                }
+
+                for (size_t i = 0; i < numSamples; ++i)
+                {
+                    if constexpr (Ramp)
+                    {
+                        c.b0 += step.b0;  c.b1 += step.b1;  c.b2 += step.b2;
+                        c.a1 += step.a1;  c.a2 += step.a2;
+                    }
+
+                    const auto x = data[i];
+                    const auto y = c.b0 * x + s1;
+                    s1 = c.b1 * x - c.a1 * y + s2;
+                    s2 = c.b2 * x - c.a2 * y;
+                    data[i] = y;
+                }
+
+                if constexpr (Ramp)
+                    band.setCurrent (ch, c);
+
+                band.s1[ch] = s1;
+                band.s2[ch] = s2;
+            }
+        }
+    }
+
+   #if JUCE_USE_SIMD
+    template <size_t NumActive, bool Ramp>
+    void processSIMD (SampleType* const* channelData, size_t channels, size_t numSamples, size_t group) noexcept
+    {
+        static_assert (NumActive > 0, "an empty group is skipped in process()");
+
+        // Gather the active bands' coefficients and state into registers for the whole block
+        Vec b0[NumActive], b1[NumActive], b2[NumActive], a1[NumActive], a2[NumActive];
+        Vec s1[NumActive], s2[NumActive];
+
+        const auto offset = group * numLanes;
+        const auto& active = activeBands[group];
+
+        for (size_t k = 0; k < NumActive; ++k)
+        {
+            const auto& band = bands[active[k]];
+            b0[k] = Vec::fromRawArray (band.b0 + offset);
+            b1[k] = Vec::fromRawArray (band.b1 + offset);
+            b2[k] = Vec::fromRawArray (band.b2 + offset);
+            a1[k] = Vec::fromRawArray (band.a1 + offset);
+            a2[k] = Vec::fromRawArray (band.a2 + offset);
+            s1[k] = Vec::fromRawArray (band.s1 + offset);
+            s2[k] = Vec::fromRawArray (band.s2 + offset);
+        }
+
+        // While ramping, each coefficient moves by a fixed step per sample
+        struct Steps { Vec b0, b1, b2, a1, a2; };
+        Steps steps[Ramp ? NumActive : 1];
+
+        if constexpr (Ramp)
+        {
+            const auto scale = SampleType (1) / (SampleType) rampRemaining;
+
+            for (size_t k = 0; k < NumActive; ++k)
+            {
+                const auto& band = bands[active[k]];
+                steps[k].b0 = (Vec::fromRawArray (band.tb0 + offset) - b0[k]) * scale;
+                steps[k].b1 = (Vec::fromRawArray (band.tb1 + offset) - b1[k]) * scale;
+                steps[k].b2 = (Vec::fromRawArray (band.tb2 + offset) - b2[k]) * scale;
+                steps[k].a1 = (Vec::fromRawArray (band.ta1 + offset) - a1[k]) * scale;
+                steps[k].a2 = (Vec::fromRawArray (band.ta2 + offset) - a2[k]) * scale;
+            }
+        }
+
+        alignas (Vec::SIMDRegisterSize) SampleType frame[numLanes] = {};
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            for (size_t ch = 0; ch < channels; ++ch)
+                frame[ch] = channelData[ch][i];
+
+            auto x = Vec::fromRawArray (frame);
+
+            for (size_t k = 0; k < NumActive; ++k)
+            {
+                if constexpr (Ramp)
+                {
+                    b0[k] += steps[k].b0;  b1[k] += steps[k].b1;  b2[k] += steps[k].b2;
+                    a1[k] += steps[k].a1;  a2[k] += steps[k].a2;
+                }
+
+                const auto y = b0[k] * x + s1[k];
+                s1[k] = b1[k] * x - a1[k] * y + s2[k];
+                s2[k] = b2[k] * x - a2[k] * y;
+                x = y;
+            }
+
+            x.copyToRawArray (frame);
+
+            for (size_t ch = 0; ch < channels; ++ch)
+                channelData[ch][i] = frame[ch];
+        }
+
+        for (size_t k = 0; k < NumActive; ++k)
+        {
+            auto& band = bands[active[k]];
+            s1[k].copyToRawArray (band.s1 + offset);
+            s2[k].copyToRawArray (band.s2 + offset);
+
+            if constexpr (Ramp)
+            {
+                b0[k].copyToRawArray (band.b0 + offset);
+                b1[k].copyToRawArray (band.b1 + offset);
+                b2[k].copyToRawArray (band.b2 + offset);
+                a1[k].copyToRawArray (band.a1 + offset);
+                a2[k].copyToRawArray (band.a2 + offset);
+            }
+        }
+    }
+
+    //==============================================================================
+    using KernelFunction = void (BiquadCascade::*) (SampleType* const*, size_t, size_t, size_t) noexcept;
+
+    template <bool Ramp, size_t... Counts>
+    static constexpr std::array<KernelFunction, sizeof... (Counts) + 1> makeSIMDKernelTable (std::index_sequence<Counts...>) noexcept
+    {
+        // Entry 0 is never called, processGroups() skips groups with no active bands
+        return { { nullptr, &BiquadCascade::processSIMD<Counts + 1, Ramp>... } };
+    }
+
+    /** Returns the fully unrolled SIMD kernel for a given active band count, with or without ramping. */
+    static KernelFunction getSIMDKernel (size_t numActive, bool ramping) noexcept
+    {
+        static constexpr auto kernels        = makeSIMDKernelTable<false> (std::make_index_sequence<MaxBands>());
+        static constexpr auto rampingKernels = makeSIMDKernelTable<true>  (std::make_index_sequence<MaxBands>());
+        return ramping ? rampingKernels[numActive] : kernels[numActive];
+    }
+   #endif
+
+    void snapStateToZero (size_t group) noexcept
+    {
+        for (size_t k = 0; k < numActiveBands[group]; ++k)
+        {
+            auto& band = bands[activeBands[group][k]];
+
+            for (size_t ch = group * numLanes; ch < (group + 1) * numLanes; ++ch)
+            {
+                JUCE_SNAP_TO_ZERO (band.s1[ch]);
+                JUCE_SNAP_TO_ZERO (band.s2[ch]);
+            }
+        }
+    }
+
+    JUCE_LEAK_DETECTOR (BiquadCascade)
+};
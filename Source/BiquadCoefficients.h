@@ -0,0 +1,143 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A plain set of normalised biquad coefficients (a0 == 1).
+
+    The values are stored in the same order JUCE's IIR::Coefficients uses
+    internally (b0, b1, b2, a1, a2), so they can be copied straight into an
+    existing Coefficients object without touching the heap.
+*/
+template <typename SampleType>
+struct BiquadCoefficients
+{
+    SampleType b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+
+    //==============================================================================
+    /**
+        RBJ peak filter, identical to IIR::Coefficients::makePeakFilter() but
+        computed on the stack so it is safe to call from the audio thread.
+    */
+    static BiquadCoefficients makePeak (double sampleRate, double frequency, double Q, double gainFactor) noexcept
+    {
+        jassert (sampleRate > 0.0);
+        jassert (frequency > 0.0 && frequency <= sampleRate * 0.5);
+        jassert (Q > 0.0);
+
+        const auto A           = juce::jmax (0.0, std::sqrt (gainFactor));
+        const auto omega       = (juce::MathConstants<double>::twoPi * juce::jmax (frequency, 2.0)) / sampleRate;
+        const auto alpha       = std::sin (omega) / (Q * 2.0);
+        const auto c2          = -2.0 * std::cos (omega);
+        const auto alphaTimesA = alpha * A;
+        const auto alphaOverA  = alpha / A;
+        const auto a0Inv       = 1.0 / (1.0 + alphaOverA);
+
+        BiquadCoefficients c;
+        c.b0 = (SampleType) ((1.0 + alphaTimesA) * a0Inv);
+        c.b1 = (SampleType) (c2 * a0Inv);
+        c.b2 = (SampleType) ((1.0 - alphaTimesA) * a0Inv);
+        c.a1 = (SampleType) (c2 * a0Inv);
+        c.a2 = (SampleType) ((1.0 - alphaOverA) * a0Inv);
+        return c;
+    }
+
+    /**
+        Peak filter matched to the analog prototype of makePeak() all the way
+        to Nyquist, after Vicanek's "Matched Second Order Digital Filters".
+
+        For a boost, the poles come from the impulse-invariant mapping of the
+        analog poles. The zeros are then chosen so the squared magnitude
+        matches the analog one exactly at DC, at the centre frequency and at
+        Nyquist. A cut is the inverse of the matching boost. Unlike the
+        bilinear transform, this doesn't squeeze peaks near Nyquist, so there's
+        no need to oversample. The cost is a few transcendental calls more than
+        makePeak(). Nothing is allocated.
+    */
+    static BiquadCoefficients makeMatchedPeak (double sampleRate, double frequency, double Q, double gainFactor) noexcept
+    {
+        jassert (sampleRate > 0.0);
+        jassert (frequency > 0.0 && frequency <= sampleRate * 0.5);
+        jassert (Q > 0.0);
+
+        // A cut is the exact inverse of the boost with the reciprocal gain. Designing the
+        // boost keeps the impulse-invariant mapping on the narrower (pole) side, where it matters.
+        if (gainFactor < 1.0)
+        {
+            const auto boost = makeMatchedPeak (sampleRate, frequency, Q, 1.0 / juce::jmax (1.0e-12, gainFactor));
+            const auto b0Inv = 1.0 / (double) boost.b0;
+
+            BiquadCoefficients c;
+            c.b0 = (SampleType) b0Inv;
+            c.b1 = (SampleType) ((double) boost.a1 * b0Inv);
+            c.b2 = (SampleType) ((double) boost.a2 * b0Inv);
+            c.a1 = (SampleType) ((double) boost.b1 * b0Inv);
+            c.a2 = (SampleType) ((double) boost.b2 * b0Inv);
+            return c;
+        }
+
+        const auto A     = std::sqrt (gainFactor);
+        const auto omega = (juce::MathConstants<double>::twoPi * juce::jlimit (2.0, sampleRate * 0.499, frequency)) / sampleRate;
+
+        // Poles: impulse invariance of s^2 + s / (A Q) + 1
+        const auto zeta = 1.0 / (2.0 * A * Q);
+        const auto a2   = std::exp (-2.0 * zeta * omega);
+        const auto a1   = zeta <= 1.0 ? -2.0 * std::exp (-zeta * omega) * std::cos (std::sqrt (1.0 - zeta * zeta) * omega)
+                                      : -2.0 * std::exp (-zeta * omega) * std::cosh (std::sqrt (zeta * zeta - 1.0) * omega);
+
+        // |H|^2 of a biquad section is linear in (phi0, phi1, phi2) for phi1 = sin^2 (w / 2)
+        const auto phi1 = juce::square (std::sin (omega * 0.5));
+        const auto phi0 = 1.0 - phi1;
+        const auto phi2 = 4.0 * phi0 * phi1;
+
+        const auto A0 = juce::square (1.0 + a1 + a2);
+        const auto A1 = juce::square (1.0 - a1 + a2);
+        const auto A2 = -4.0 * a2;
+
+        // Analog |H|^2 at Nyquist, in units of the centre frequency
+        const auto nyquist   = juce::MathConstants<double>::pi / omega;
+        const auto detune    = juce::square (1.0 - nyquist * nyquist);
+        const auto nyquistSq = (detune + juce::square (nyquist * A / Q)) / (detune + juce::square (nyquist / (A * Q)));
+
+        // Numerator terms: unity at DC, the analog level at Nyquist, A^4 at the centre
+        const auto B0 = A0;
+        const auto B1 = A1 * nyquistSq;
+        const auto B2 = (A * A * A * A * (A0 * phi0 + A1 * phi1 + A2 * phi2) - B0 * phi0 - B1 * phi1) / phi2;
+
+        // Back to b0, b1, b2, picking the minimum-phase root
+        const auto root0 = std::sqrt (B0);
+        const auto root1 = std::sqrt (B1);
+        const auto W     = 0.5 * (root0 + root1);
+
+        BiquadCoefficients c;
+        const auto b0 = 0.5 * (W + std::sqrt (juce::jmax (0.0, W * W + B2)));
+
+        c.b0 = (SampleType) b0;
+        c.b1 = (SampleType) (0.5 * (root0 - root1));
+        c.b2 = (SampleType) (-B2 / (4.0 * b0));
+        c.a1 = (SampleType) a1;
+        c.a2 = (SampleType) a2;
+        return c;
+    }
+
+    /** The same coefficients in another sample type, e.g. a double design for a float cascade. */
+    template <typename OtherType>
+    BiquadCoefficients<OtherType> withType() const noexcept
+    {
+        return { (OtherType) b0, (OtherType) b1, (OtherType) b2, (OtherType) a1, (OtherType) a2 };
+    }
+
+    /** Writes these values into an existing (second-order) IIR::Coefficients object in place. */
+    void copyTo (juce::dsp::IIR::Coefficients<SampleType>& dest) const noexcept
+    {
+        jassert (dest.getFilterOrder() == 2);
+
+        auto* raw = dest.getRawCoefficients();
+        raw[0] = b0;
+        raw[1] = b1;
+        raw[2] = b2;
+        raw[3] = a1;
+        raw[4] = a2;
+    }
+};
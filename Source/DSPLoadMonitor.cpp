@@ -0,0 +1,100 @@
+#include "DSPLoadMonitor.h"
+
+#if SPECTRALEQ_ENABLE_PROFILING
+
+//==============================================================================
+void DSPLoadMonitor::prepare (double newSampleRate) noexcept
+{
+    jassert (newSampleRate > 0.0);
+    ticksPerSample = (double) juce::Time::getHighResolutionTicksPerSecond() / newSampleRate;
+
+    // The budget changes with the rate, so earlier blocks no longer compare
+    reset();
+}
+
+DSPLoadMonitor::Stats DSPLoadMonitor::getStats (Section section) const noexcept
+{
+    const auto& histogram = histograms[(size_t) section];
+
+    std::array<juce::uint32, (size_t) numBins> counts;
+    juce::uint64 numBlocks = 0;
+
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        counts[i] = histogram.bins[i].load (std::memory_order_relaxed);
+        numBlocks += counts[i];
+    }
+
+    Stats stats;
+    stats.numBlocks = numBlocks;
+    stats.max       = histogram.max.load (std::memory_order_relaxed);
+
+    if (numBlocks == 0)
+        return stats;
+
+    // Each percentile is the upper edge of the bin it falls in, but never above the exact maximum
+    auto percentile = [&] (double proportion)
+    {
+        const auto rank = (juce::uint64) std::ceil (proportion * (double) numBlocks);
+        juce::uint64 cumulative = 0;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            cumulative += counts[i];
+
+            if (cumulative >= rank)
+                return juce::jmin (stats.max, (float) (i + 1) / (float) binsPerBudget);
+        }
+
+        return stats.max;
+    };
+
+    stats.p50 = percentile (0.5);
+    stats.p99 = percentile (0.99);
+    return stats;
+}
+
+//==============================================================================
+void DSPLoadMonitor::beginBlock() noexcept
+{
+    if (resetRequested.exchange (false))
+    {
+        for (auto& histogram : histograms)
+        {
+            for (auto& bin : histogram.bins)
+                bin.store (0, std::memory_order_relaxed);
+
+            histogram.max.store (0.0f, std::memory_order_relaxed);
+        }
+
+        nearDeadlineBlocks.store (0, std::memory_order_relaxed);
+    }
+
+    blockTicks.fill (0);
+}
+
+void DSPLoadMonitor::endBlock (int numSamples, juce::int64 totalTicks) noexcept
+{
+    if (numSamples <= 0 || ticksPerSample <= 0.0)
+        return;
+
+    blockTicks[(size_t) total] = totalTicks;
+    const auto budgetTicks = ticksPerSample * (double) numSamples;
+
+    for (size_t s = 0; s < histograms.size(); ++s)
+    {
+        auto& histogram = histograms[s];
+        const auto load = (float) ((double) blockTicks[s] / budgetTicks);
+        const auto bin  = (size_t) juce::jlimit (0, numBins - 1, (int) (load * (float) binsPerBudget));
+
+        increment (histogram.bins[bin]);
+
+        if (load > histogram.max.load (std::memory_order_relaxed))
+            histogram.max.store (load, std::memory_order_relaxed);
+    }
+
+    if ((double) totalTicks >= budgetTicks * (double) nearDeadlineLoad)
+        nearDeadlineBlocks.store (nearDeadlineBlocks.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Set to 1 to time every processBlock() with a DSPLoadMonitor. On by default
+    in debug builds; in release builds it's compiled out completely unless
+    this is defined to 1.
+*/
+#ifndef SPECTRALEQ_ENABLE_PROFILING
+ #if JUCE_DEBUG
+  #define SPECTRALEQ_ENABLE_PROFILING 1
+ #else
+  #define SPECTRALEQ_ENABLE_PROFILING 0
+ #endif
+#endif
+
+#if SPECTRALEQ_ENABLE_PROFILING
+
+//==============================================================================
+/**
+    Per-instance DSP load: how much of each block's real-time budget
+    (numSamples / sampleRate) processBlock() used, overall and split into
+    sections.
+
+    The audio thread opens a ScopedBlock around the whole block and a
+    ScopedSection around each timed part, which read the high-resolution
+    tick counter (a monotonic clock) on the way in and out. At the end of the
+    block, each section's load goes into its own histogram. The histograms
+    have 1/128-budget bins up to twice the budget, plus an exact maximum.
+
+    Only the audio thread writes. Every counter is an atomic it updates with
+    plain relaxed loads and stores, so recording a block costs no locked
+    instructions. Any thread can call getStats() at any time, and reset() only
+    raises a flag the audio thread acts on at its next block. A query may
+    straddle a block, which just means it's one block out of date.
+*/
+class DSPLoadMonitor
+{
+public:
+    //==============================================================================
+    enum Section
+    {
+        total,          // the whole processBlock()
+        filter,         // the cascade, modulated bands, oversampling or linear-phase convolution
+        coefficients,   // parameter pickup, smoothing steps, redesigns and the modulation source
+        analyser,       // handing samples to the analyser
+        numSections
+    };
+
+    /** A block whose total load reaches this share of its budget counts as near the deadline. */
+    static constexpr float nearDeadlineLoad = 0.8f;
+
+    struct Stats
+    {
+        float p50 = 0.0f, p99 = 0.0f, max = 0.0f;      // as a share of the block's budget, 1 = all of it
+        juce::uint64 numBlocks = 0;
+    };
+
+    //==============================================================================
+    DSPLoadMonitor() = default;
+
+    /** Call from prepareToPlay(). */
+    void prepare (double newSampleRate) noexcept;
+
+    /** Any thread: clears every histogram before the next block is recorded. */
+    void reset() noexcept      { resetRequested.store (true); }
+
+    /** Any thread. */
+    Stats getStats (Section section) const noexcept;
+
+    /** Any thread: the number of blocks whose total load reached nearDeadlineLoad. */
+    juce::uint64 getNumNearDeadlineBlocks() const noexcept     { return nearDeadlineBlocks.load (std::memory_order_relaxed); }
+
+    //==============================================================================
+    /** Audio thread: times one processBlock() and records it when it goes out of scope. */
+    struct ScopedBlock
+    {
+        ScopedBlock (DSPLoadMonitor& m, int numSamplesToRecord) noexcept
+            : monitor (m), numSamples (numSamplesToRecord), start (juce::Time::getHighResolutionTicks())
+        {
+            monitor.beginBlock();
+        }
+
+        ~ScopedBlock()
+        {
+            monitor.endBlock (numSamples, juce::Time::getHighResolutionTicks() - start);
+        }
+
+        DSPLoadMonitor& monitor;
+        const int numSamples;
+        const juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    /** Audio thread: adds the time until it goes out of scope to one section of the current block. */
+    struct ScopedSection
+    {
+        ScopedSection (DSPLoadMonitor& m, Section s) noexcept
+            : monitor (m), section (s), start (juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedSection()
+        {
+            monitor.blockTicks[(size_t) section] += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        DSPLoadMonitor& monitor;
+        const Section section;
+        const juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedSection)
+    };
+
+private:
+    //==============================================================================
+    static constexpr int binsPerBudget = 128;
+    static constexpr int numBins       = 2 * binsPerBudget;     // the last bin also holds everything over twice the budget
+
+    struct Histogram
+    {
+        std::array<std::atomic<juce::uint32>, (size_t) numBins> bins {};
+        std::atomic<float> max { 0.0f };
+    };
+
+    void beginBlock() noexcept;
+    void endBlock (int numSamples, juce::int64 totalTicks) noexcept;
+
+    // Written by the audio thread only
+    static void increment (std::atomic<juce::uint32>& counter) noexcept
+    {
+        counter.store (counter.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::array<Histogram, (size_t) numSections> histograms;
+    std::atomic<juce::uint64> nearDeadlineBlocks { 0 };
+    std::atomic<bool> resetRequested { false };
+
+    // Audio thread: the sections' ticks so far in the current block
+    std::array<juce::int64, (size_t) numSections> blockTicks {};
+    double ticksPerSample = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DSPLoadMonitor)
+};
+
+/** Times the rest of the enclosing scope as one processBlock() of numSamples samples. */
+#define SPECTRALEQ_PROFILE_BLOCK(monitor, numSamples) \
+    const DSPLoadMonitor::ScopedBlock JUCE_JOIN_MACRO (profiledBlock, __LINE__) (monitor, numSamples)
+
+/** Adds the rest of the enclosing scope to a section of the current block. */
+#define SPECTRALEQ_PROFILE_SECTION(monitor, section) \
+    const DSPLoadMonitor::ScopedSection JUCE_JOIN_MACRO (profiledSection, __LINE__) (monitor, DSPLoadMonitor::section)
+
+#else
+
+#define SPECTRALEQ_PROFILE_BLOCK(monitor, numSamples)
+#define SPECTRALEQ_PROFILE_SECTION(monitor, section)
+
+#endif
@@ -0,0 +1,142 @@
+#include "FrequencyModulator.h"
+
+//==============================================================================
+void FrequencyModulator::prepare (double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    values.assign ((size_t) juce::jmax (1, maximumBlockSize), 0.0f);
+
+    attackCoefficient  = (float) std::exp (-1.0 / (0.005 * sampleRate));
+    releaseCoefficient = (float) std::exp (-1.0 / (0.150 * sampleRate));
+
+    reset();
+}
+
+void FrequencyModulator::reset() noexcept
+{
+    phase    = 0.0;
+    envelope = 0.0f;
+
+    noteOrder.fill (0);
+    currentNote = -1;
+}
+
+void FrequencyModulator::setParameters (Source newSource, float newRateHz, float newDepthOctaves) noexcept
+{
+    source = newSource;
+    rate   = newRateHz;
+    depth  = newDepthOctaves;
+}
+
+//==============================================================================
+template <typename SampleType>
+const float* FrequencyModulator::process (const juce::AudioBuffer<SampleType>& input, const juce::MidiBuffer& midi) noexcept
+{
+    jassert (input.getNumSamples() <= (int) values.size());
+    const auto numSamples = juce::jmin (input.getNumSamples(), (int) values.size());
+
+    // Each stretch between two MIDI events uses the note held over it
+    int position = 0;
+
+    for (const auto metadata : midi)
+    {
+        const auto eventPosition = juce::jlimit (position, numSamples, metadata.samplePosition);
+
+        fill (input, position, eventPosition);
+        position = eventPosition;
+
+        handleMidiEvent (metadata.data, metadata.numBytes);
+    }
+
+    fill (input, position, numSamples);
+
+    return source == Source::off ? nullptr : values.data();
+}
+
+template const float* FrequencyModulator::process (const juce::AudioBuffer<float>&,  const juce::MidiBuffer&) noexcept;
+template const float* FrequencyModulator::process (const juce::AudioBuffer<double>&, const juce::MidiBuffer&) noexcept;
+
+template <typename SampleType>
+void FrequencyModulator::fill (const juce::AudioBuffer<SampleType>& input, int start, int end) noexcept
+{
+    switch (source)
+    {
+        case Source::off:
+            break;
+
+        case Source::lfo:
+        {
+            const auto increment = juce::MathConstants<double>::twoPi * (double) rate / sampleRate;
+
+            for (int i = start; i < end; ++i)
+            {
+                values[(size_t) i] = depth * (float) std::sin (phase);
+
+                phase += increment;
+
+                if (phase >= juce::MathConstants<double>::twoPi)
+                    phase -= juce::MathConstants<double>::twoPi;
+            }
+
+            break;
+        }
+
+        case Source::envelope:
+        {
+            for (int i = start; i < end; ++i)
+            {
+                float level = 0.0f;
+
+                for (int ch = 0; ch < input.getNumChannels(); ++ch)
+                    level = juce::jmax (level, (float) std::abs (input.getSample (ch, i)));
+
+                const auto coefficient = level > envelope ? attackCoefficient : releaseCoefficient;
+                envelope = level + coefficient * (envelope - level);
+
+                values[(size_t) i] = depth * juce::jmin (envelope, 1.0f);
+            }
+
+            break;
+        }
+
+        case Source::midiNote:
+        {
+            const auto octaves = currentNote >= 0 ? depth * (float) (currentNote - 60) / 12.0f : 0.0f;
+            std::fill (values.begin() + start, values.begin() + end, octaves);
+            break;
+        }
+    }
+}
+
+void FrequencyModulator::handleMidiEvent (const juce::uint8* data, int numBytes) noexcept
+{
+    // Only three-byte channel messages matter here, which also skips SysEx
+    if (numBytes != 3)
+        return;
+
+    const auto status = data[0] & 0xf0;
+    const auto note   = data[1] & 0x7f;
+
+    // A note on with velocity 0 is a note off
+    if (status == 0x90 && data[2] != 0)
+    {
+        currentNote = note;
+        noteOrder[(size_t) currentNote] = ++noteCounter;
+    }
+    else if (status == 0x80 || status == 0x90)
+    {
+        noteOrder[(size_t) note] = 0;
+
+        // Back to the most recent note still held, if any
+        if (note == currentNote)
+        {
+            const auto latest = std::max_element (noteOrder.begin(), noteOrder.end());
+            currentNote = *latest != 0 ? (int) std::distance (noteOrder.begin(), latest) : -1;
+        }
+    }
+    else if (status == 0xb0 && (data[1] == 123 || data[1] == 120))     // all notes off, all sound off
+    {
+        noteOrder.fill (0);
+        currentNote = -1;
+    }
+}
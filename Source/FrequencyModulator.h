@@ -0,0 +1,71 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The signal that moves the modulated bands' frequencies: one value per
+    sample, in octaves.
+
+    - LFO: a sine at the given rate, swinging +-depth octaves.
+    - Envelope: a peak follower on the loudest input channel (5 ms attack,
+      150 ms release), from 0 at silence up to depth octaves at full scale.
+    - MIDI note: depth * (note - 60) / 12 octaves, so a depth of 1 tracks the
+      keyboard around middle C. The last note held wins, and releasing every
+      note returns to 0. Notes take effect at their sample position in the
+      block.
+
+    Notes are tracked whatever the source, so a note that's already held
+    takes effect as soon as the source is switched to MIDI. The value buffer
+    is allocated in prepare(); process() never allocates.
+*/
+class FrequencyModulator
+{
+public:
+    //==============================================================================
+    enum class Source { off, lfo, envelope, midiNote };
+
+    /** Allocates room for blocks of up to maximumBlockSize samples. */
+    void prepare (double sampleRate, int maximumBlockSize);
+
+    /** Restarts the LFO, empties the envelope and releases every note. */
+    void reset() noexcept;
+
+    /** Audio thread: picks up the current settings before process(). */
+    void setParameters (Source newSource, float newRateHz, float newDepthOctaves) noexcept;
+
+    /**
+        Audio thread: works out the modulation for the block, before it gets
+        filtered. Returns one value per sample, or nullptr while the source
+        is off.
+    */
+    template <typename SampleType>
+    const float* process (const juce::AudioBuffer<SampleType>& input, const juce::MidiBuffer& midi) noexcept;
+
+private:
+    //==============================================================================
+    template <typename SampleType>
+    void fill (const juce::AudioBuffer<SampleType>& input, int start, int end) noexcept;
+
+    // Reads the raw bytes: building a juce::MidiMessage for a long SysEx would allocate
+    void handleMidiEvent (const juce::uint8* data, int numBytes) noexcept;
+
+    std::vector<float> values;
+    double sampleRate = 44100.0;
+
+    Source source = Source::off;
+    float  rate   = 1.0f;
+    float  depth  = 1.0f;
+
+    double phase = 0.0;                 // LFO, 0 .. 2 pi
+
+    float envelope = 0.0f;
+    float attackCoefficient = 0.0f, releaseCoefficient = 0.0f;
+
+    // Held notes, by when they were pressed (0 = not held), for last-note priority
+    std::array<juce::uint32, 128> noteOrder {};
+    juce::uint32 noteCounter = 0;
+    int currentNote = -1;
+
+    JUCE_LEAK_DETECTOR (FrequencyModulator)
+};
@@ -0,0 +1,305 @@
+#include "LinearPhaseEQ.h"
+
+//==============================================================================
+LinearPhaseEQ::LinearPhaseEQ()
+    : juce::Thread ("SpectralEQ Linear Phase")
+{
+    for (int q = 0; q < numQualities; ++q)
+    {
+        const auto firLength = getFIRLength (q);
+        const auto fftOrder  = juce::roundToInt (std::log2 (getPartitionSize (q) * 2));
+
+        designFFTs[(size_t) q]           = SharedResources::getFFT (juce::roundToInt (std::log2 (firLength)));
+        builderPartitionFFTs[(size_t) q] = SharedResources::getFFT (fftOrder);
+        partitionFFTs[(size_t) q]        = std::make_unique<juce::dsp::FFT> (fftOrder);
+
+        // Periodic Blackman: symmetric about firLength / 2, where the impulse is centred
+        windows[(size_t) q] = SharedResources::getWindow (SharedResources::Window::periodicBlackman, firLength);
+    }
+
+    designData.resize ((size_t) maxFIRLength * 2);
+    taps.resize ((size_t) maxFIRLength);
+    partitionData.resize ((size_t) maxPartitionSize * 4);
+
+    fftWork.resize ((size_t) maxPartitionSize * 4);
+    accumulator.resize ((size_t) maxPartitionSize * 4);
+    fadeBuffer.resize ((size_t) maxPartitionSize);
+}
+
+LinearPhaseEQ::~LinearPhaseEQ()
+{
+    release();
+}
+
+//==============================================================================
+void LinearPhaseEQ::prepare (double newSampleRate, int numChannels)
+{
+    release();
+
+    sampleRate = newSampleRate;
+    quality    = requestedQuality.load();
+
+    channelStates.resize ((size_t) juce::jmax (1, numChannels));
+
+    for (auto& channel : channelStates)
+    {
+        channel.input.resize ((size_t) maxPartitionSize * 2);
+        channel.output.resize ((size_t) maxPartitionSize);
+        channel.delayLine.resize ((size_t) numPartitions * maxSpectrumSize);
+    }
+
+    reset();
+
+    // Build the first kernel right away so playback doesn't start silent
+    kernelIsStale = true;
+    buildIfNeeded();
+
+    startThread (juce::Thread::Priority::low);
+}
+
+void LinearPhaseEQ::release()
+{
+    stopThread (1000);
+}
+
+void LinearPhaseEQ::reset() noexcept
+{
+    for (auto& channel : channelStates)
+    {
+        std::fill (channel.input.begin(), channel.input.end(), 0.0f);
+        std::fill (channel.output.begin(), channel.output.end(), 0.0f);
+        std::fill (channel.delayLine.begin(), channel.delayLine.end(), 0.0f);
+    }
+
+    fillPos = 0;
+    fdlPos  = 0;
+}
+
+//==============================================================================
+void LinearPhaseEQ::setSections (const BiquadCoefficients<float>* sections, size_t numSections,
+                                 double designRateRatio) noexcept
+{
+    auto& design = designs.getWriteBuffer();
+    design.numSections = juce::jmin (numSections, maxSections);
+    design.rateRatio   = designRateRatio;
+    std::copy_n (sections, design.numSections, design.sections.begin());
+    designs.publish();
+}
+
+void LinearPhaseEQ::setQuality (int newQuality) noexcept
+{
+    requestedQuality.store (juce::jlimit (0, numQualities - 1, newQuality));
+}
+
+//==============================================================================
+void LinearPhaseEQ::run()
+{
+    // The audio thread can't wake us without taking a lock, so new sections are polled for while
+    // active. In minimum-phase mode there's nothing to build: sleep until wakeBuilder().
+    while (! threadShouldExit())
+        if (! buildIfNeeded())
+            wait (active.load() ? 10 : -1);
+}
+
+bool LinearPhaseEQ::buildIfNeeded()
+{
+    if (designs.acquireLatest())
+        kernelIsStale = true;
+
+    const auto q = requestedQuality.load();
+
+    if (q != builtQuality)
+        kernelIsStale = true;
+
+    if (! kernelIsStale || ! active.load())
+        return false;
+
+    buildKernel (designs.getReadBuffer(), q);
+    builtQuality  = q;
+    kernelIsStale = false;
+    return true;
+}
+
+void LinearPhaseEQ::buildKernel (const Design& design, int q)
+{
+    using Complex = std::complex<double>;
+
+    const auto firLength     = getFIRLength (q);
+    const auto partitionSize = getPartitionSize (q);
+    const auto spectrumSize  = getSpectrumSize (q);
+
+    // Magnitude response of the cascade on bins 0..firLength / 2, with zero phase.
+    // The inverse transform fills in the negative frequencies itself.
+    for (int k = 0; k <= firLength / 2; ++k)
+    {
+        const auto w  = juce::MathConstants<double>::twoPi * (double) k / ((double) firLength * design.rateRatio);
+        const auto z1 = std::polar (1.0, -w);
+        const auto z2 = std::polar (1.0, -2.0 * w);
+
+        double magnitude = 1.0;
+
+        for (size_t s = 0; s < design.numSections; ++s)
+        {
+            const auto& c = design.sections[s];
+            magnitude *= std::abs ((double) c.b0 + (double) c.b1 * z1 + (double) c.b2 * z2)
+                       / std::abs (Complex (1.0) + (double) c.a1 * z1 + (double) c.a2 * z2);
+        }
+
+        designData[(size_t) k * 2]     = (float) magnitude;
+        designData[(size_t) k * 2 + 1] = 0.0f;
+    }
+
+    designFFTs[(size_t) q]->performRealOnlyInverseTransform (designData.data());
+
+    // The zero-phase response wraps around sample 0: centre it on firLength / 2 and window it
+    const auto& window = *windows[(size_t) q];
+
+    for (int n = 0; n < firLength; ++n)
+        taps[(size_t) n] = designData[(size_t) ((n + firLength / 2) % firLength)] * window[(size_t) n];
+
+    // Split into partitions and transform each one, zero-padded to twice its length
+    auto& kernel = kernels.getWriteBuffer();
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        std::fill (partitionData.begin(), partitionData.end(), 0.0f);
+        std::copy_n (taps.begin() + p * partitionSize, partitionSize, partitionData.begin());
+
+        builderPartitionFFTs[(size_t) q]->performRealOnlyForwardTransform (partitionData.data(), true);
+        std::copy_n (partitionData.begin(), spectrumSize, kernel.spectra.begin() + p * spectrumSize);
+    }
+
+    kernel.quality    = q;
+    kernel.sampleRate = sampleRate;
+    kernels.publish();
+}
+
+//==============================================================================
+template <typename SampleType>
+void LinearPhaseEQ::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+
+    if (context.isBypassed)
+        return;
+
+    // A new preset means a new partition layout: start from silence until its kernel arrives
+    if (const auto q = requestedQuality.load (std::memory_order_relaxed); q != quality)
+    {
+        quality = q;
+        reset();
+    }
+
+    const auto channels      = juce::jmin (block.getNumChannels(), channelStates.size());
+    const auto numSamples    = block.getNumSamples();
+    const auto partitionSize = (size_t) getPartitionSize (quality);
+
+    for (size_t done = 0; done < numSamples;)
+    {
+        const auto chunk = juce::jmin (numSamples - done, partitionSize - (size_t) fillPos);
+
+        for (size_t ch = 0; ch < channels; ++ch)
+        {
+            auto& channel = channelStates[ch];
+            auto* data    = block.getChannelPointer (ch) + done;
+
+            std::copy_n (data, chunk, channel.input.begin() + (std::ptrdiff_t) (partitionSize + (size_t) fillPos));
+            std::copy_n (channel.output.begin() + fillPos, chunk, data);
+        }
+
+        fillPos += (int) chunk;
+        done    += chunk;
+
+        if (fillPos == (int) partitionSize)
+        {
+            convolveBlock (channels);
+            fillPos = 0;
+        }
+    }
+}
+
+template void LinearPhaseEQ::process (const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void LinearPhaseEQ::process (const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+
+bool LinearPhaseEQ::isUsable (const Kernel& kernel) const noexcept
+{
+    return kernel.quality == quality && kernel.sampleRate == sampleRate;
+}
+
+void LinearPhaseEQ::convolveBlock (size_t numChannelsToProcess) noexcept
+{
+    const auto partitionSize = getPartitionSize (quality);
+    const auto spectrumSize  = getSpectrumSize (quality);
+    auto& fft = *partitionFFTs[(size_t) quality];
+
+    // Transform the last two partitions of input into the newest delay line slot
+    fdlPos = (fdlPos + 1) % numPartitions;
+
+    for (size_t ch = 0; ch < numChannelsToProcess; ++ch)
+    {
+        auto& channel = channelStates[ch];
+
+        std::copy_n (channel.input.begin(), partitionSize * 2, fftWork.begin());
+        fft.performRealOnlyForwardTransform (fftWork.data(), true);
+        std::copy_n (fftWork.begin(), spectrumSize, channel.delayLine.begin() + fdlPos * spectrumSize);
+
+        std::copy_n (channel.input.begin() + partitionSize, partitionSize, channel.input.begin());
+    }
+
+    // Filter with the current kernel first: picking up a new one hands the old slot back to the builder
+    const auto hadKernel = isUsable (kernels.getReadBuffer());
+
+    for (size_t ch = 0; ch < numChannelsToProcess; ++ch)
+    {
+        auto& channel = channelStates[ch];
+
+        if (hadKernel)
+            convolve (channel, kernels.getReadBuffer(), channel.output.data());
+        else
+            std::fill (channel.output.begin(), channel.output.end(), 0.0f);
+    }
+
+    if (! kernels.acquireLatest() || ! isUsable (kernels.getReadBuffer()))
+        return;
+
+    // Crossfade to the new kernel over this partition (a fade-in if there was none)
+    for (size_t ch = 0; ch < numChannelsToProcess; ++ch)
+    {
+        auto& channel = channelStates[ch];
+        convolve (channel, kernels.getReadBuffer(), fadeBuffer.data());
+
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            const auto t = (float) i / (float) partitionSize;
+            channel.output[(size_t) i] += t * (fadeBuffer[(size_t) i] - channel.output[(size_t) i]);
+        }
+    }
+}
+
+void LinearPhaseEQ::convolve (const ChannelState& channel, const Kernel& kernel, float* dest) noexcept
+{
+    const auto partitionSize = getPartitionSize (quality);
+    const auto spectrumSize  = getSpectrumSize (quality);
+
+    // Sum of (input spectrum from p partitions ago) x (kernel partition p)
+    std::fill (accumulator.begin(), accumulator.begin() + spectrumSize, 0.0f);
+    auto* y = accumulator.data();
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const auto slot = (fdlPos + numPartitions - p) % numPartitions;
+        const auto* x = channel.delayLine.data() + slot * spectrumSize;
+        const auto* h = kernel.spectra.data() + p * spectrumSize;
+
+        for (int k = 0; k < spectrumSize; k += 2)
+        {
+            y[k]     += x[k] * h[k]     - x[k + 1] * h[k + 1];
+            y[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+        }
+    }
+
+    partitionFFTs[(size_t) quality]->performRealOnlyInverseTransform (y);
+
+    // Overlap-save: the first half is wrapped around, the second half is the output
+    std::copy_n (accumulator.begin() + partitionSize, partitionSize, dest);
+}
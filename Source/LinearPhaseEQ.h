@@ -0,0 +1,162 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCoefficients.h"
+#include "TripleBuffer.h"
+#include "SharedResources.h"
+
+//==============================================================================
+/**
+    Linear-phase version of the EQ: a symmetric FIR with the same magnitude
+    response as the biquad cascade, applied with uniformly partitioned FFT
+    convolution (overlap-save, one frequency-domain delay line per channel).
+
+    The audio thread passes the current band coefficients to setSections()
+    whenever they change. A background thread samples the cascade's magnitude
+    response, turns it into a zero-phase impulse response with an inverse FFT,
+    centres and windows it, and splits it into partition spectra. Finished
+    kernels come back through a triple buffer, and the audio thread crossfades
+    from the old kernel to the new one over one partition, so nothing on the
+    audio thread ever waits for a rebuild.
+
+    The quality presets trade latency for low-frequency resolution (the FIR is
+    fs / length Hz per bin). The latency is half the FIR length, for the
+    linear-phase delay, plus one partition for the input buffering. Every
+    preset's FFTs and buffers are allocated up front, so changing preset just
+    clears the signal path and waits for the matching kernel. The builder's
+    FFT plans and windows are shared with every other instance through
+    SharedResources; the audio thread's plans are its own.
+*/
+class LinearPhaseEQ  : private juce::Thread
+{
+public:
+    //==============================================================================
+    /** Low latency, balanced and high quality. */
+    static constexpr int numQualities   = 3;
+    static constexpr int defaultQuality = 1;
+
+    /** Every preset uses the same number of partitions; only their size changes. */
+    static constexpr int numPartitions = 16;
+
+    static constexpr size_t maxSections = 32;
+
+    static constexpr int getFIRLength (int quality) noexcept         { return 4096 << quality; }
+    static constexpr int getPartitionSize (int quality) noexcept     { return getFIRLength (quality) / numPartitions; }
+    static constexpr int getLatencySamples (int quality) noexcept    { return getFIRLength (quality) / 2 + getPartitionSize (quality); }
+
+    //==============================================================================
+    LinearPhaseEQ();
+    ~LinearPhaseEQ() override;
+
+    /**
+        Allocates the signal path, builds the first kernel from the sections
+        passed so far (if active) and starts the builder thread.
+    */
+    void prepare (double sampleRate, int numChannels);
+
+    /** Stops the builder thread. */
+    void release();
+
+    /** Audio thread: clears the signal path. The current kernel is kept. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /**
+        Audio thread: hands a new set of sections to the builder. Wait-free.
+        If the sections were designed for an oversampled rate, pass the ratio:
+        the FIR then follows their uncramped response below Nyquist.
+    */
+    void setSections (const BiquadCoefficients<float>* sections, size_t numSections,
+                      double designRateRatio = 1.0) noexcept;
+
+    /** Any thread: selects a quality preset, 0..numQualities - 1. */
+    void setQuality (int quality) noexcept;
+
+    /**
+        Any thread: kernels are only built while active. The builder sleeps
+        while inactive and waking it takes a lock, so after switching on, call
+        wakeBuilder() from a thread that may block.
+    */
+    void setActive (bool shouldBeActive) noexcept     { active.store (shouldBeActive); }
+
+    /** Message thread: wakes the builder if it's asleep, so it notices setActive (true). */
+    void wakeBuilder()                                { notify(); }
+
+    //==============================================================================
+    /**
+        Audio thread: filters the block in place, delayed by getLatencySamples().
+        The convolution itself always runs in float; double blocks are
+        converted on the way through the input and output buffers.
+    */
+    template <typename SampleType>
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+    //==============================================================================
+    static constexpr int maxFIRLength     = 4096 << (numQualities - 1);
+    static constexpr int maxPartitionSize = maxFIRLength / numPartitions;
+    static constexpr int maxSpectrumSize  = maxPartitionSize * 2 + 2;
+
+    /** Complex bins 0..partitionSize of a 2 * partitionSize real FFT, interleaved. */
+    static constexpr int getSpectrumSize (int quality) noexcept     { return getPartitionSize (quality) * 2 + 2; }
+
+    struct Design
+    {
+        std::array<BiquadCoefficients<float>, maxSections> sections;
+        size_t numSections = 0;
+        double rateRatio   = 1.0;       // design rate / sampleRate
+    };
+
+    struct Kernel
+    {
+        Kernel() : spectra ((size_t) numPartitions * maxSpectrumSize) {}
+
+        std::vector<float> spectra;     // numPartitions spectra of getSpectrumSize (quality)
+        int    quality    = -1;
+        double sampleRate = 0.0;
+    };
+
+    struct ChannelState
+    {
+        std::vector<float> input;       // previous and current partition, 2 * maxPartitionSize
+        std::vector<float> output;      // the partition being played out
+        std::vector<float> delayLine;   // numPartitions input spectra, newest at fdlPos
+    };
+
+    //==============================================================================
+    // Builder thread
+    void run() override;
+    bool buildIfNeeded();
+    void buildKernel (const Design& design, int quality);
+
+    // Audio thread
+    void convolveBlock (size_t numChannelsToProcess) noexcept;
+    void convolve (const ChannelState& channel, const Kernel& kernel, float* dest) noexcept;
+    bool isUsable (const Kernel& kernel) const noexcept;
+
+    //==============================================================================
+    std::atomic<int>  requestedQuality { defaultQuality };
+    std::atomic<bool> active { false };
+
+    TripleBuffer<Design> designs;       // audio thread -> builder
+    TripleBuffer<Kernel> kernels;       // builder -> audio thread
+
+    double sampleRate = 44100.0;
+
+    // Builder thread state; separate FFT plans so the two threads never share one
+    std::array<std::shared_ptr<const juce::dsp::FFT>, numQualities>     designFFTs, builderPartitionFFTs;
+    std::array<std::shared_ptr<const std::vector<float>>, numQualities> windows;
+    std::vector<float> designData, taps, partitionData;
+    int  builtQuality  = -1;
+    bool kernelIsStale = true;
+
+    // Audio thread state
+    std::array<std::unique_ptr<juce::dsp::FFT>, numQualities> partitionFFTs;
+    std::vector<ChannelState> channelStates;
+    std::vector<float> fftWork, accumulator, fadeBuffer;
+    int quality = defaultQuality;
+    int fillPos = 0;                    // samples of the current partition received so far
+    int fdlPos  = 0;                    // delay line slot of the newest partition
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseEQ)
+};
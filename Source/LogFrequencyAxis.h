@@ -0,0 +1,122 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedResources.h"
+
+//==============================================================================
+/**
+    Maps FFT bins onto a row or column of pixels with a logarithmic frequency
+    axis, from minFrequency at pixel 0 to maxFrequency at the last pixel.
+
+    The table is looked up again by update() only when the pixel count, FFT
+    size or sample rate actually changes, so drawing a frame is a straight
+    walk over it. Tables are shared through SharedResources, so every axis of
+    the same size, FFT size and rate in the process uses one copy. Where many
+    bins share one pixel, getLevelRange() collapses them to their min and max;
+    where one bin spans many pixels (the low end of a small FFT), it
+    interpolates between the two nearest bins instead.
+*/
+class LogFrequencyAxis
+{
+public:
+    //==============================================================================
+    static constexpr double minFrequency = 20.0;
+    static constexpr double maxFrequency = 20000.0;
+
+    LogFrequencyAxis() = default;
+
+    /** Message thread: switches to the table for these settings if anything changed. Returns true if it did. */
+    bool update (int newNumPixels, int newNumBins, double newSampleRate)
+    {
+        if (newNumPixels == numPixels && newNumBins == numBins && newSampleRate == sampleRate)
+            return false;
+
+        numPixels  = juce::jmax (0, newNumPixels);
+        numBins    = juce::jmax (0, newNumBins);
+        sampleRate = newSampleRate;
+
+        pixels = SharedResources::get<PixelTable> (std::make_tuple (numPixels, numBins, sampleRate),
+                                                   [this] { return buildTable(); });
+        return true;
+    }
+
+    int getNumPixels() const noexcept       { return numPixels; }
+
+    /** Where a frequency falls along the axis, 0 at minFrequency and 1 at maxFrequency. */
+    static double frequencyToProportion (double frequency) noexcept
+    {
+        return std::log (frequency / minFrequency) / std::log (maxFrequency / minFrequency);
+    }
+
+    /** Level range covered by one pixel. decibels must hold the numBins passed to update(). */
+    void getLevelRange (int pixel, const float* decibels, float& minLevel, float& maxLevel) const noexcept
+    {
+        const auto& p = (*pixels)[(size_t) pixel];
+
+        if (p.endBin > p.firstBin)
+        {
+            minLevel = maxLevel = decibels[p.firstBin];
+
+            for (int bin = p.firstBin + 1; bin < p.endBin; ++bin)
+            {
+                minLevel = juce::jmin (minLevel, decibels[bin]);
+                maxLevel = juce::jmax (maxLevel, decibels[bin]);
+            }
+
+            return;
+        }
+
+        // No bin centre falls inside this pixel: interpolate at the pixel centre
+        const auto lower = juce::jmin ((int) p.centreBin, juce::jmax (0, numBins - 2));
+        const auto frac  = p.centreBin - (float) lower;
+
+        minLevel = maxLevel = decibels[lower] + frac * (decibels[lower + 1] - decibels[lower]);
+    }
+
+private:
+    //==============================================================================
+    struct Pixel
+    {
+        int   firstBin  = 0;    // bins [firstBin, endBin) have their centre in this pixel
+        int   endBin    = 0;
+        float centreBin = 0.0f; // fractional bin at the pixel centre
+    };
+
+    using PixelTable = std::vector<Pixel>;
+
+    std::unique_ptr<PixelTable> buildTable() const
+    {
+        auto table = std::make_unique<PixelTable> ((size_t) numPixels);
+
+        if (numBins < 2 || sampleRate <= 0.0)
+            return table;
+
+        // Bin i sits at i * sampleRate / fftSize, and fftSize = 2 * numBins
+        const auto binsPerHz = 2.0 * (double) numBins / sampleRate;
+        const auto lastBin   = (double) (numBins - 1);
+
+        auto pixelEdgeToBin = [&] (double edge)
+        {
+            const auto frequency = minFrequency * std::pow (maxFrequency / minFrequency, edge / (double) numPixels);
+            return juce::jlimit (1.0, lastBin, frequency * binsPerHz);
+        };
+
+        for (int x = 0; x < numPixels; ++x)
+        {
+            const auto low  = pixelEdgeToBin ((double) x);
+            const auto high = pixelEdgeToBin ((double) x + 1.0);
+
+            auto& p = (*table)[(size_t) x];
+            p.firstBin   = (int) std::ceil (low);
+            p.endBin     = (int) std::ceil (high);
+            p.centreBin  = (float) (0.5 * (low + high));
+        }
+
+        return table;
+    }
+
+    std::shared_ptr<const PixelTable> pixels;
+    int    numPixels  = 0;
+    int    numBins    = 0;
+    double sampleRate = 0.0;
+};
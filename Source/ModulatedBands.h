@@ -0,0 +1,287 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PeakCoefficientTable.h"
+#include "SharedResources.h"
+
+//==============================================================================
+/**
+    The EQ bands whose frequency follows a modulation signal, redesigned on
+    every sample from a PeakCoefficientTable.
+
+    Each band has a base frequency (as log2 (frequency / rate)), a Q and gain
+    shape and a channel, either all of them or one. Like BiquadCascade's
+    coefficients, these are set at the control rate, either at once or as a
+    target that startRamp() glides to over the next N samples.
+
+    process() takes one modulation value per sample, in octaves. For each
+    sample it shifts every running band's base frequency by that amount,
+    redesigns all the bands in one makePeaks() call, and passes each channel
+    through them. When the block is oversampled, each modulation value is
+    held for the 2^order samples it covers. The sections are transposed
+    direct form II, like BiquadCascade's, and run in band order.
+
+    Nothing here allocates after construction. The PeakCoefficientTable is
+    shared by every instance in the process through SharedResources.
+*/
+template <typename SampleType, size_t MaxBands, size_t MaxChannels = 16>
+class ModulatedBands
+{
+public:
+    using Shape = PeakCoefficientTable::Shape;
+
+    //==============================================================================
+    void prepare (const juce::dsp::ProcessSpec& spec) noexcept
+    {
+        numChannels = juce::jmin ((size_t) spec.numChannels, MaxChannels);
+        jassert (spec.numChannels <= MaxChannels);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& band : bands)
+            band.clearState();
+    }
+
+    /** Enables or disables a band. A band that gets enabled starts from a clean state. */
+    void setBandEnabled (size_t bandIndex, bool shouldBeEnabled) noexcept
+    {
+        jassert (bandIndex < MaxBands);
+
+        if (enabled[bandIndex] == shouldBeEnabled)
+            return;
+
+        enabled[bandIndex] = shouldBeEnabled;
+
+        if (shouldBeEnabled)
+            bands[bandIndex].clearState();
+
+        numActiveBands = 0;
+
+        for (size_t b = 0; b < MaxBands; ++b)
+            if (enabled[b])
+                activeBands[numActiveBands++] = b;
+    }
+
+    bool isBandEnabled (size_t bandIndex) const noexcept    { return enabled[bandIndex]; }
+
+    size_t getNumActiveBands() const noexcept               { return numActiveBands; }
+
+    //==============================================================================
+    /**
+        Sets a band's base octave, shape and channel (-1 for every channel),
+        cancelling any ramp it was in.
+    */
+    void setBand (size_t bandIndex, float octave, Shape shape, int channel) noexcept
+    {
+        auto& band = bands[bandIndex];
+        band.current = band.target = { octave, shape.A, shape.halfInvQ };
+        band.channel = channel;
+    }
+
+    /** Sets the base octave and shape a band ramps to. Nothing moves until startRamp() is called. */
+    void setBandTarget (size_t bandIndex, float octave, Shape shape) noexcept
+    {
+        bands[bandIndex].target = { octave, shape.A, shape.halfInvQ };
+    }
+
+    /** Starts moving every band towards its target, reaching it after exactly numSamples processed samples. */
+    void startRamp (size_t numSamples) noexcept
+    {
+        rampRemaining = numSamples;
+
+        if (numSamples == 0)
+            for (auto& band : bands)
+                band.current = band.target;
+    }
+
+    /** The largest magnitude in any running band's state. */
+    SampleType getStateMagnitude() const noexcept
+    {
+        SampleType magnitude {};
+
+        for (size_t k = 0; k < numActiveBands; ++k)
+        {
+            const auto& band = bands[activeBands[k]];
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                magnitude = juce::jmax (magnitude, std::abs (band.s1[ch]), std::abs (band.s2[ch]));
+        }
+
+        return magnitude;
+    }
+
+    //==============================================================================
+    /**
+        Filters the block in place. modulation holds one value in octaves per
+        sample of the block at the base rate, or is nullptr for none; the block
+        itself may be oversampled by 2^oversamplingOrder.
+    */
+    void process (juce::dsp::AudioBlock<SampleType>& block, const float* modulation, int oversamplingOrder) noexcept
+    {
+        const auto channels = juce::jmin (block.getNumChannels(), numChannels);
+        const auto n        = block.getNumSamples();
+
+        if (numActiveBands == 0 || n == 0)
+            return;
+
+        SampleType* channelData[MaxChannels] = {};
+
+        for (size_t ch = 0; ch < channels; ++ch)
+            channelData[ch] = block.getChannelPointer (ch);
+
+        // Gather the running bands into contiguous arrays for makePeaks()
+        for (size_t k = 0; k < numActiveBands; ++k)
+        {
+            const auto& band = bands[activeBands[k]];
+            current.octave[k]   = band.current.octave;
+            current.A[k]        = band.current.A;
+            current.halfInvQ[k] = band.current.halfInvQ;
+        }
+
+        const auto rampLength = juce::jmin (n, rampRemaining);
+
+        if (rampLength > 0)
+        {
+            const auto scale = 1.0f / (float) rampRemaining;
+
+            for (size_t k = 0; k < numActiveBands; ++k)
+            {
+                const auto& band = bands[activeBands[k]];
+                step.octave[k]   = (band.target.octave   - current.octave[k])   * scale;
+                step.A[k]        = (band.target.A        - current.A[k])        * scale;
+                step.halfInvQ[k] = (band.target.halfInvQ - current.halfInvQ[k]) * scale;
+            }
+
+            processRange<true> (channelData, channels, 0, rampLength, modulation, oversamplingOrder);
+            rampRemaining -= rampLength;
+
+            if (rampRemaining == 0)
+            {
+                for (auto& band : bands)
+                    band.current = band.target;
+
+                for (size_t k = 0; k < numActiveBands; ++k)
+                {
+                    const auto& band = bands[activeBands[k]];
+                    current.octave[k]   = band.current.octave;
+                    current.A[k]        = band.current.A;
+                    current.halfInvQ[k] = band.current.halfInvQ;
+                }
+            }
+        }
+
+        if (rampLength < n)
+            processRange<false> (channelData, channels, rampLength, n, modulation, oversamplingOrder);
+
+        for (size_t k = 0; k < numActiveBands; ++k)
+        {
+            auto& band = bands[activeBands[k]];
+
+            if (rampRemaining > 0)
+                band.current = { current.octave[k], current.A[k], current.halfInvQ[k] };
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                JUCE_SNAP_TO_ZERO (band.s1[ch]);
+                JUCE_SNAP_TO_ZERO (band.s2[ch]);
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct Values
+    {
+        float octave = -4.0f, A = 1.0f, halfInvQ = 0.5f;
+    };
+
+    struct BandData
+    {
+        Values current, target;
+        int channel = -1;
+
+        SampleType s1[MaxChannels] = {};
+        SampleType s2[MaxChannels] = {};
+
+        void clearState() noexcept
+        {
+            std::fill (std::begin (s1), std::end (s1), SampleType());
+            std::fill (std::begin (s2), std::end (s2), SampleType());
+        }
+    };
+
+    /** The running bands' values, one array per field. */
+    struct BandArrays
+    {
+        float octave[MaxBands], A[MaxBands], halfInvQ[MaxBands];
+    };
+
+    template <bool Ramp>
+    void processRange (SampleType* const* channelData, size_t channels, size_t start, size_t end,
+                       const float* modulation, int oversamplingOrder) noexcept
+    {
+        for (size_t i = start; i < end; ++i)
+        {
+            const auto offset = modulation != nullptr ? modulation[i >> oversamplingOrder] : 0.0f;
+
+            for (size_t k = 0; k < numActiveBands; ++k)
+            {
+                if constexpr (Ramp)
+                {
+                    current.octave[k]   += step.octave[k];
+                    current.A[k]        += step.A[k];
+                    current.halfInvQ[k] += step.halfInvQ[k];
+                }
+
+                octaves[k] = current.octave[k] + offset;
+            }
+
+            table->makePeaks (octaves, current.A, current.halfInvQ, numActiveBands,
+                             coefficients.b0, coefficients.b1, coefficients.b2, coefficients.a1, coefficients.a2);
+
+            for (size_t ch = 0; ch < channels; ++ch)
+            {
+                auto x = channelData[ch][i];
+
+                for (size_t k = 0; k < numActiveBands; ++k)
+                {
+                    auto& band = bands[activeBands[k]];
+
+                    if (band.channel >= 0 && band.channel != (int) ch)
+                        continue;
+
+                    const auto y = (SampleType) coefficients.b0[k] * x + band.s1[ch];
+                    band.s1[ch] = (SampleType) coefficients.b1[k] * x - (SampleType) coefficients.a1[k] * y + band.s2[ch];
+                    band.s2[ch] = (SampleType) coefficients.b2[k] * x - (SampleType) coefficients.a2[k] * y;
+                    x = y;
+                }
+
+                channelData[ch][i] = x;
+            }
+        }
+    }
+
+    //==============================================================================
+    std::shared_ptr<const PeakCoefficientTable> table
+        = SharedResources::get<PeakCoefficientTable> ([] { return std::make_unique<PeakCoefficientTable>(); });
+
+    std::array<BandData, MaxBands> bands;
+    std::array<bool, MaxBands>     enabled {};
+
+    std::array<size_t, MaxBands> activeBands {};
+    size_t numActiveBands = 0;
+
+    // Per-block working arrays, in active band order
+    BandArrays current, step;
+    float octaves[MaxBands];
+
+    struct { float b0[MaxBands], b1[MaxBands], b2[MaxBands], a1[MaxBands], a2[MaxBands]; } coefficients;
+
+    size_t numChannels   = 0;
+    size_t rampRemaining = 0;
+
+    JUCE_LEAK_DETECTOR (ModulatedBands)
+};
@@ -5,8 +5,9 @@ SpectralEQAudioProcessorEditor::SpectralEQAudioProcessorEditor (SpectralEQAudioP
     : AudioProcessorEditor (&p),
       audioProcessor (p)
 {
-    // Set the plugin window size
-    setSize (800, 500);
+    // Set the plugin window size. paint() covers every pixel, so nothing behind needs repainting.
+    setOpaque (true);
+    setSize (900, 500);
 
     // Helper lambda for repeated slider setup
     auto setupSlider = [this](juce::Slider& s)
@@ -16,40 +17,82 @@ SpectralEQAudioProcessorEditor::SpectralEQAudioProcessorEditor (SpectralEQAudioP
         addAndMakeVisible (s);
     };
 
-    // Prepare all 9 sliders
-    setupSlider (band1FreqSlider);
-    setupSlider (band1GainSlider);
-    setupSlider (band1QSlider);
-
-    setupSlider (band2FreqSlider);
-    setupSlider (band2GainSlider);
-    setupSlider (band2QSlider);
-
-    setupSlider (band3FreqSlider);
-    setupSlider (band3GainSlider);
-    setupSlider (band3QSlider);
-
-    // Attach each slider to a parameter
-    band1FreqAttachment  = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band1Freq", band1FreqSlider);
-    band1GainAttachment  = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band1Gain", band1GainSlider);
-    band1QAttachment     = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band1Q",    band1QSlider);
-
-    band2FreqAttachment  = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band2Freq", band2FreqSlider);
-    band2GainAttachment  = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band2Gain", band2GainSlider);
-    band2QAttachment     = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band2Q",    band2QSlider);
-
-    band3FreqAttachment  = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band3Freq", band3FreqSlider);
-    band3GainAttachment  = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band3Gain", band3GainSlider);
-    band3QAttachment     = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-                                audioProcessor.apvts, "Band3Q",    band3QSlider);
+    setupSlider (freqSlider);
+    setupSlider (gainSlider);
+    setupSlider (qSlider);
+    addAndMakeVisible (enabledButton);
+
+    // Channel choices are the same for every band: "All" (linked), then one per channel
+    if (auto* channel = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter (
+                            SpectralEQAudioProcessor::getBandParameterID (0, "Channel"))))
+        channelBox.addItemList (channel->choices, 1);
+
+    addAndMakeVisible (channelBox);
+    addAndMakeVisible (modButton);
+
+    // Band selector: item IDs are 1-based band numbers
+    for (size_t i = 0; i < SpectralEQAudioProcessor::maxBands; ++i)
+        bandSelector.addItem ("Band " + juce::String ((int) i + 1), (int) i + 1);
+
+    bandSelector.onChange = [this] { attachToBand ((size_t) bandSelector.getSelectedId() - 1); };
+    addAndMakeVisible (bandSelector);
+
+    bandSelector.setSelectedId (1, juce::dontSendNotification);
+    attachToBand (0);
+
+    // Analyser settings: the boxes take their items from the choice parameters
+    auto setupChoiceBox = [this](juce::ComboBox& box, const juce::String& paramID,
+                                 std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>& attachment)
+    {
+        if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter (paramID)))
+            box.addItemList (choice->choices, 1);
+
+        addAndMakeVisible (box);
+        attachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+                         audioProcessor.apvts, paramID, box);
+    };
+
+    setupChoiceBox (fftSizeBox, "FFTOrder", fftSizeAttachment);
+    setupChoiceBox (overlapBox, "Overlap",  overlapAttachment);
+
+    setupChoiceBox (phaseModeBox,    "PhaseMode",     phaseModeAttachment);
+    setupChoiceBox (qualityBox,      "LinearQuality", qualityAttachment);
+    setupChoiceBox (oversamplingBox, "Oversampling",  oversamplingAttachment);
+    setupChoiceBox (peakDesignBox,   "PeakDesign",    peakDesignAttachment);
+    setupChoiceBox (modSourceBox,    "ModSource",     modSourceAttachment);
+
+    // Modulation rate and depth as small horizontal sliders under the source
+    for (auto* slider : { &modRateSlider, &modDepthSlider })
+    {
+        slider->setSliderStyle (juce::Slider::LinearHorizontal);
+        slider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 50, 20);
+        addAndMakeVisible (*slider);
+    }
+
+    modRateAttachment  = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "ModRate",  modRateSlider);
+    modDepthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "ModDepth", modDepthSlider);
+
+    // Preset bank: every change to A, B or the morph position goes straight to the processor
+    bankButton.onClick = [this] { showBankMenu(); };
+    addAndMakeVisible (bankButton);
+
+    for (auto* box : { &presetABox, &presetBBox })
+    {
+        box->onChange = [this] { sendPresetMorph(); };
+        addAndMakeVisible (*box);
+    }
+
+    morphSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    morphSlider.setTextBoxStyle (juce::Slider::NoTextBox, false, 0, 0);
+    morphSlider.setRange (0.0, 1.0);
+    morphSlider.setValue (audioProcessor.getPresetMorphPosition(), juce::dontSendNotification);
+    morphSlider.onValueChange = [this] { sendPresetMorph(); };
+    addAndMakeVisible (morphSlider);
+
+    refreshPresetBoxes();
+
+    // The analysis only runs while the spectrum is on screen
+    audioProcessor.analyser.addConsumer();
 
     // Start a timer to repaint the spectrogram ~30 fps
     startTimerHz (30);
@@ -58,11 +101,122 @@ SpectralEQAudioProcessorEditor::SpectralEQAudioProcessorEditor (SpectralEQAudioP
 SpectralEQAudioProcessorEditor::~SpectralEQAudioProcessorEditor()
 {
     // Attachments clean themselves up
+    audioProcessor.analyser.removeConsumer();
 }
 
 //==============================================================================
 void SpectralEQAudioProcessorEditor::paint (juce::Graphics& g)
 {
+   #if SPECTRALEQ_SHOW_PAINT_TIME
+    const auto paintStart = juce::Time::getHighResolutionTicks();
+   #endif
+
+    // Background, title and scope grid come from the cache, which is only
+    // redrawn after a resize or when the window moves to a different scale
+    const auto scale = juce::Component::getApproximateScaleFactorForComponent (this);
+
+    if (backgroundCache.isNull() || scale != backgroundScale)
+        renderBackground (scale);
+
+    g.drawImage (backgroundCache, getLocalBounds().toFloat());
+
+    // Spectrum line in the top part of the scope, waterfall underneath.
+    // One or two vertices per pixel column: the min and max of the bins in it.
+    const auto& frame = audioProcessor.analyser.getLatestFrame();
+
+    spectrumPath.clear();
+    spectrumPath.startNewSubPath ((float) spectrumArea.getX(),
+                                  (float) spectrumArea.getBottom());
+
+    if (frame.numBins >= 2 && spectrumAxis.getNumPixels() == spectrumArea.getWidth())
+    {
+        // -100 dB .. 0 dB -> bottom .. top
+        const auto yScale = (float) spectrumArea.getHeight() / -100.0f;
+        const auto yTop   = (float) spectrumArea.getY();
+
+        for (int px = 0; px < spectrumArea.getWidth(); ++px)
+        {
+            float minLevel, maxLevel;
+            spectrumAxis.getLevelRange (px, frame.decibels.data(), minLevel, maxLevel);
+
+            const auto x = (float) (spectrumArea.getX() + px) + 0.5f;
+            spectrumPath.lineTo (x, yTop + maxLevel * yScale);
+
+            if (minLevel < maxLevel)
+                spectrumPath.lineTo (x, yTop + minLevel * yScale);
+        }
+    }
+
+    g.setColour (juce::Colours::green);
+    g.strokePath (spectrumPath, juce::PathStrokeType (1.5f));
+
+    waterfall.draw (g, waterfallArea);
+
+   #if SPECTRALEQ_ENABLE_PROFILING
+    paintLoadReadout (g);
+   #endif
+
+   #if SPECTRALEQ_SHOW_PAINT_TIME
+    // Shows the average of the previous paints; this one is still being timed
+    g.setColour (juce::Colours::yellow);
+    g.setFont (juce::Font().withHeight (12.0f));
+    g.drawText (juce::String (averagePaintMs, 2) + " ms/paint",
+                spectrumArea.withHeight (16).withLeft (spectrumArea.getRight() - 100),
+                juce::Justification::centredRight);
+    g.drawText (juce::String ((juce::int64) audioProcessor.getNumIdleBlocks()) + " idle blocks",
+                spectrumArea.withTrimmedTop (16).withHeight (16).withLeft (spectrumArea.getRight() - 140),
+                juce::Justification::centredRight);
+
+    const auto paintMs = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - paintStart) * 1000.0;
+    averagePaintMs += (paintMs - averagePaintMs) * 0.1;
+   #endif
+}
+
+#if SPECTRALEQ_ENABLE_PROFILING
+void SpectralEQAudioProcessorEditor::paintLoadReadout (juce::Graphics& g)
+{
+    // One line per section: median, 99th percentile and worst block, as a share of the block's budget
+    static constexpr std::pair<DSPLoadMonitor::Section, const char*> sections[] =
+    {
+        { DSPLoadMonitor::total,        "DSP"      },
+        { DSPLoadMonitor::filter,       "filters"  },
+        { DSPLoadMonitor::coefficients, "coeffs"   },
+        { DSPLoadMonitor::analyser,     "analyser" }
+    };
+
+    const auto& monitor = audioProcessor.getLoadMonitor();
+    const auto percent  = [] (float load) { return juce::String (load * 100.0f, 1) + "%"; };
+
+    g.setColour (juce::Colours::yellow);
+    g.setFont (juce::Font().withHeight (12.0f));
+
+    auto line = spectrumArea.withHeight (16).withWidth (260).translated (4, 0);
+
+    for (const auto& [section, name] : sections)
+    {
+        const auto stats = monitor.getStats (section);
+        g.drawText (juce::String (name) + "  p50 " + percent (stats.p50) + "  p99 " + percent (stats.p99)
+                      + "  max " + percent (stats.max),
+                    line, juce::Justification::centredLeft);
+        line = line.translated (0, 16);
+    }
+
+    g.drawText (juce::String ((juce::int64) monitor.getNumNearDeadlineBlocks()) + " blocks near the deadline",
+                line, juce::Justification::centredLeft);
+}
+#endif
+
+void SpectralEQAudioProcessorEditor::renderBackground (float scale)
+{
+    backgroundScale = scale;
+    backgroundCache = juce::Image (juce::Image::RGB,
+                                   juce::jmax (1, juce::roundToInt ((float) getWidth()  * scale)),
+                                   juce::jmax (1, juce::roundToInt ((float) getHeight() * scale)),
+                                   false);
+
+    juce::Graphics g (backgroundCache);
+    g.addTransform (juce::AffineTransform::scale (scale));
+
     // Background
     g.fillAll (juce::Colours::black);
 
@@ -71,81 +225,257 @@ void SpectralEQAudioProcessorEditor::paint (juce::Graphics& g)
     // Use the new Font constructor style
     g.setFont (juce::Font().withHeight (18.0f).withTypefaceStyle ("Bold"));
 
-    g.drawFittedText ("Spectral EQ (3-Band) + Spectrogram", 10, 10, 300, 30,
+    g.drawFittedText ("Spectral EQ + Spectrogram", 10, 10, 300, 30,
                       juce::Justification::left, 1);
 
-    // We'll draw the FFT-based path below the sliders
-    auto scopeRect = getLocalBounds().withTop (150).reduced (10);
+    // Level grid every 20 dB, matching the -100..0 dB range of the spectrum line
+    g.setColour (juce::Colours::darkgrey);
 
-    juce::Path freqPath;
-    freqPath.startNewSubPath ((float) scopeRect.getX(),
-                              (float) scopeRect.getBottom());
+    for (int dB = -20; dB > -100; dB -= 20)
+    {
+        const auto y = spectrumArea.getY() + spectrumArea.getHeight() * -dB / 100;
+        g.drawHorizontalLine (y, (float) spectrumArea.getX(), (float) spectrumArea.getRight());
+    }
 
-    // We'll plot magnitude data from indices [1..(fftSize/2 - 1)]
-    const auto halfSize = SpectralEQAudioProcessor::fftSize / 2;
+    // Frequency grid on the same log axis as the spectrum
+    g.setFont (juce::Font().withHeight (11.0f));
 
-    for (size_t i = 1; i < halfSize; ++i)
+    for (auto frequency : { 50, 100, 200, 500, 1000, 2000, 5000, 10000 })
     {
-        float dBValue = audioProcessor.scopeData[i];
-
-        // Map from -100 dB .. 0 dB -> vertical range
-        float yNorm = juce::jmap (dBValue,
-                                  -100.0f,
-                                  0.0f,
-                                  (float) scopeRect.getHeight(),
-                                  0.0f);
-
-        // Map from i -> horizontal range
-        float xNorm = juce::jmap ((float) i,
-                                  0.0f,
-                                  (float) halfSize,
-                                  0.0f,
-                                  (float) scopeRect.getWidth());
-
-        float x = (float) scopeRect.getX() + xNorm;
-        float y = (float) scopeRect.getY() + yNorm;
-        freqPath.lineTo (x, y);
-    }
+        const auto x = spectrumArea.getX()
+                     + juce::roundToInt (LogFrequencyAxis::frequencyToProportion (frequency) * (double) spectrumArea.getWidth());
 
-    g.setColour (juce::Colours::green);
-    g.strokePath (freqPath, juce::PathStrokeType (1.5f));
+        g.setColour (juce::Colours::darkgrey);
+        g.drawVerticalLine (x, (float) spectrumArea.getY(), (float) spectrumArea.getBottom());
+
+        g.setColour (juce::Colours::grey);
+        g.drawText (frequency >= 1000 ? juce::String (frequency / 1000) + "k" : juce::String (frequency),
+                    x + 2, spectrumArea.getBottom() - 14, 40, 14, juce::Justification::left);
+    }
 }
 
 void SpectralEQAudioProcessorEditor::resized()
 {
-    // Lay out the 9 sliders across the top
+    // Band selector under the title, then the selected band's controls across the top
     auto area = getLocalBounds().reduced (10);
     auto sliderArea = area.removeFromTop (140);
 
+    // The scope takes the rest: spectrum on top, waterfall below it
+    scopeArea    = area;
+    spectrumArea = area.removeFromTop (area.getHeight() * 2 / 5);
+    area.removeFromTop (6);
+    waterfallArea = area;
+    waterfall.setSize (waterfallArea.getWidth(), waterfallArea.getHeight());
+
+    const auto& frame = audioProcessor.analyser.getLatestFrame();
+    spectrumAxis.update (spectrumArea.getWidth(), frame.numBins, frame.sampleRate);
+
+    // The grid depends on the layout, so the cached background is stale
+    backgroundCache = {};
+
+    auto selectorArea = sliderArea.removeFromLeft (160).withTrimmedTop (40);
+    bandSelector.setBounds  (selectorArea.removeFromTop (24));
+    enabledButton.setBounds (selectorArea.removeFromTop (30));
+    channelBox.setBounds    (selectorArea.removeFromTop (24));
+    modButton.setBounds     (selectorArea.removeFromTop (22));
+
+    // Preset bank along the top, right of the title
+    auto presetRow = sliderArea.withHeight (24).withTrimmedLeft (310).translated (0, 6);
+    bankButton.setBounds (presetRow.removeFromLeft (60));
+    presetRow.removeFromLeft (6);
+    presetABox.setBounds (presetRow.removeFromLeft (150));
+    presetBBox.setBounds (presetRow.removeFromRight (150));
+    morphSlider.setBounds (presetRow.reduced (6, 0));
+
+    // Analyser settings and the peak design on the right
+    auto analyserArea = sliderArea.removeFromRight (120).withTrimmedTop (40);
+    fftSizeBox.setBounds (analyserArea.removeFromTop (24));
+    analyserArea.removeFromTop (6);
+    overlapBox.setBounds (analyserArea.removeFromTop (24));
+    analyserArea.removeFromTop (6);
+    peakDesignBox.setBounds (analyserArea.removeFromTop (24));
+
+    // Phase mode and oversampling next to them
+    auto phaseArea = sliderArea.removeFromRight (130).withTrimmedTop (40).withTrimmedRight (10);
+    phaseModeBox.setBounds (phaseArea.removeFromTop (24));
+    phaseArea.removeFromTop (6);
+    qualityBox.setBounds (phaseArea.removeFromTop (24));
+    phaseArea.removeFromTop (6);
+    oversamplingBox.setBounds (phaseArea.removeFromTop (24));
+
+    // Modulation source, rate and depth
+    auto modArea = sliderArea.removeFromRight (130).withTrimmedTop (40).withTrimmedRight (10);
+    modSourceBox.setBounds (modArea.removeFromTop (24));
+    modArea.removeFromTop (4);
+    modRateSlider.setBounds (modArea.removeFromTop (24));
+    modArea.removeFromTop (4);
+    modDepthSlider.setBounds (modArea.removeFromTop (24));
+
     const int columnWidth = sliderArea.getWidth() / 3;
 
-    // Band 1
+    freqSlider.setBounds (sliderArea.removeFromLeft (columnWidth));
+    gainSlider.setBounds (sliderArea.removeFromLeft (columnWidth));
+    qSlider.setBounds    (sliderArea);
+}
+
+//==============================================================================
+void SpectralEQAudioProcessorEditor::showBankMenu()
+{
+    juce::PopupMenu menu;
+    menu.addItem ("Load bank...", [this] { chooseBankFile (false); });
+    menu.addItem ("Add current settings to bank...", [this] { chooseBankFile (true); });
+
+    menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (bankButton));
+}
+
+void SpectralEQAudioProcessorEditor::chooseBankFile (bool addCurrentSettings)
+{
+    const auto bank = audioProcessor.getPresetBank();
+    const auto start = bank != nullptr ? bank->getFile() : juce::File::getSpecialLocation (juce::File::userDocumentsDirectory);
+
+    bankChooser = std::make_unique<juce::FileChooser> (addCurrentSettings ? "Add to preset bank" : "Load preset bank",
+                                                       start, "*.eqbank");
+
+    const auto flags = addCurrentSettings ? juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                          : juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+
+    bankChooser->launchAsync (flags, [this, addCurrentSettings] (const juce::FileChooser& chooser)
     {
-        auto bandArea = sliderArea.removeFromLeft (columnWidth);
-        band1FreqSlider.setBounds (bandArea.removeFromTop (bandArea.getHeight() / 3));
-        band1GainSlider.setBounds (bandArea.removeFromTop (bandArea.getHeight() / 2));
-        band1QSlider.setBounds    (bandArea);
-    }
-    // Band 2
+        const auto file = chooser.getResult();
+
+        if (file == juce::File())
+            return;
+
+        if (addCurrentSettings)
+        {
+            addCurrentSettingsToBank (file);
+            return;
+        }
+
+        if (const auto result = audioProcessor.loadPresetBank (file); result.failed())
+            juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon, "Preset bank", result.getErrorMessage());
+
+        refreshPresetBoxes();
+    });
+}
+
+void SpectralEQAudioProcessorEditor::addCurrentSettingsToBank (const juce::File& file)
+{
+    // The presets of the bank already in that file, if it's the loaded one, then the current settings
+    juce::StringArray names;
+    juce::Array<juce::MemoryBlock> states;
+
+    if (const auto bank = audioProcessor.getPresetBank(); bank != nullptr && bank->getFile() == file)
     {
-        auto bandArea = sliderArea.removeFromLeft (columnWidth);
-        band2FreqSlider.setBounds (bandArea.removeFromTop (bandArea.getHeight() / 3));
-        band2GainSlider.setBounds (bandArea.removeFromTop (bandArea.getHeight() / 2));
-        band2QSlider.setBounds    (bandArea);
+        for (int p = 0; p < bank->getNumPresets(); ++p)
+        {
+            names.add (bank->getName (p));
+            states.add (bank->getState (p));
+        }
     }
-    // Band 3
+
+    juce::MemoryBlock current;
+    audioProcessor.getStateInformation (current);
+    names.add ("Preset " + juce::String (names.size() + 1));
+    states.add (current);
+
+    auto result = PresetBank::write (file, names, states);
+
+    if (result.wasOk())
+        result = audioProcessor.loadPresetBank (file);
+
+    if (result.failed())
+        juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon, "Preset bank", result.getErrorMessage());
+
+    refreshPresetBoxes();
+}
+
+void SpectralEQAudioProcessorEditor::refreshPresetBoxes()
+{
+    const auto bank = audioProcessor.getPresetBank();
+    const auto numPresets = bank != nullptr ? bank->getNumPresets() : 0;
+
+    // Item IDs are 1-based preset numbers
+    for (auto* box : { &presetABox, &presetBBox })
     {
-        auto bandArea = sliderArea.removeFromLeft (columnWidth);
-        band3FreqSlider.setBounds (bandArea.removeFromTop (bandArea.getHeight() / 3));
-        band3GainSlider.setBounds (bandArea.removeFromTop (bandArea.getHeight() / 2));
-        band3QSlider.setBounds    (bandArea);
+        box->clear (juce::dontSendNotification);
+        box->setTextWhenNothingSelected (numPresets > 0 ? "Preset" : "No bank");
+
+        for (int p = 0; p < numPresets; ++p)
+            box->addItem (juce::String (p + 1) + " " + bank->getName (p), p + 1);
+
+        box->setEnabled (numPresets > 0);
     }
+
+    syncPresetControls();
+    morphSlider.setEnabled (numPresets > 0);
+}
+
+void SpectralEQAudioProcessorEditor::syncPresetControls()
+{
+    // Program changes and the host's program menu select presets behind the editor's back
+    const auto numPresets = presetABox.getNumItems();
+
+    if (numPresets == 0)
+        return;
+
+    presetABox.setSelectedId (juce::jlimit (0, numPresets - 1, audioProcessor.getSelectedPreset (false)) + 1, juce::dontSendNotification);
+    presetBBox.setSelectedId (juce::jlimit (0, numPresets - 1, audioProcessor.getSelectedPreset (true))  + 1, juce::dontSendNotification);
+
+    if (const auto position = audioProcessor.getPresetMorphPosition(); position != (float) morphSlider.getValue())
+        morphSlider.setValue (position, juce::dontSendNotification);
+}
+
+void SpectralEQAudioProcessorEditor::sendPresetMorph()
+{
+    if (presetABox.getSelectedId() > 0 && presetBBox.getSelectedId() > 0)
+        audioProcessor.setPresetMorph (presetABox.getSelectedId() - 1, presetBBox.getSelectedId() - 1, (float) morphSlider.getValue());
+}
+
+void SpectralEQAudioProcessorEditor::attachToBand (size_t bandIndex)
+{
+    using Attachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+
+    // Drop the old attachments first so they can't fight over the controls
+    freqAttachment.reset();
+    gainAttachment.reset();
+    qAttachment.reset();
+    enabledAttachment.reset();
+    channelAttachment.reset();
+    modAttachment.reset();
+
+    auto& apvts = audioProcessor.apvts;
+    freqAttachment    = std::make_unique<Attachment> (apvts, SpectralEQAudioProcessor::getBandParameterID (bandIndex, "Freq"), freqSlider);
+    gainAttachment    = std::make_unique<Attachment> (apvts, SpectralEQAudioProcessor::getBandParameterID (bandIndex, "Gain"), gainSlider);
+    qAttachment       = std::make_unique<Attachment> (apvts, SpectralEQAudioProcessor::getBandParameterID (bandIndex, "Q"),    qSlider);
+    enabledAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (
+                            apvts, SpectralEQAudioProcessor::getBandParameterID (bandIndex, "On"), enabledButton);
+    channelAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (
+                            apvts, SpectralEQAudioProcessor::getBandParameterID (bandIndex, "Channel"), channelBox);
+    modAttachment     = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (
+                            apvts, SpectralEQAudioProcessor::getBandParameterID (bandIndex, "Mod"), modButton);
 }
 
 //==============================================================================
 void SpectralEQAudioProcessorEditor::timerCallback()
 {
-    // If new FFT data is ready, repaint the spectrogram
-    if (audioProcessor.newDataReady.exchange (false))
-        repaint();
+    // Keeps the morph controls on the processor's selection, so the next touch morphs from there
+    syncPresetControls();
+
+    // Pick up the newest complete frame and repaint only if it's one we haven't drawn
+    auto& analyser = audioProcessor.analyser;
+    analyser.fetchLatestFrame();
+
+    if (analyser.getLatestFrameNumber() != lastPaintedFrame)
+    {
+        lastPaintedFrame = analyser.getLatestFrameNumber();
+
+        // Only rebuilds the bin mapping if the FFT size or sample rate changed
+        const auto& frame = analyser.getLatestFrame();
+        spectrumAxis.update (spectrumArea.getWidth(), frame.numBins, frame.sampleRate);
+        waterfall.pushFrame (frame);
+
+        // Only the scope changes from frame to frame
+        repaint (scopeArea);
+    }
 }
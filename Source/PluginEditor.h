@@ -2,12 +2,26 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "WaterfallDisplay.h"
+#include "LogFrequencyAxis.h"
+
+/** Set to 1 to show the average paint() time over the scope. On by default in debug builds. */
+#ifndef SPECTRALEQ_SHOW_PAINT_TIME
+ #if JUCE_DEBUG
+  #define SPECTRALEQ_SHOW_PAINT_TIME 1
+ #else
+  #define SPECTRALEQ_SHOW_PAINT_TIME 0
+ #endif
+#endif
 
 //==============================================================================
 /**
     Our Editor shows:
-    - 3 sets of sliders (Freq, Gain, Q) for each band
-    - A real-time spectrogram of the output signal
+    - A band selector with Freq, Gain and Q sliders, an On switch and a Mod
+      switch, plus the modulation source, rate and depth
+    - A preset bank row: A and B presets with a morph slider between them
+    - A real-time spectrum of the output signal, with a scrolling waterfall
+      of its recent history underneath
 */
 class SpectralEQAudioProcessorEditor  : public juce::AudioProcessorEditor,
                                         private juce::Timer
@@ -22,23 +36,86 @@ public:
 private:
     SpectralEQAudioProcessor& audioProcessor;
 
-    // We'll have 9 sliders total (3 freq, 3 gain, 3 Q).
-    juce::Slider band1FreqSlider, band1GainSlider, band1QSlider;
-    juce::Slider band2FreqSlider, band2GainSlider, band2QSlider;
-    juce::Slider band3FreqSlider, band3GainSlider, band3QSlider;
+    // One set of controls, re-attached to whichever band is selected
+    juce::ComboBox     bandSelector;
+    juce::Slider       freqSlider, gainSlider, qSlider;
+    juce::ToggleButton enabledButton { "On" };
+    juce::ComboBox     channelBox;
+    juce::ToggleButton modButton { "Mod" };
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> freqAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gainAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> qAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> enabledAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> channelAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> modAttachment;
+
+    // Frequency modulation, shared by every band whose Mod switch is on
+    juce::ComboBox modSourceBox;
+    juce::Slider   modRateSlider, modDepthSlider;
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> modSourceAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>   modRateAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>   modDepthAttachment;
+
+    // Analyser settings
+    juce::ComboBox fftSizeBox, overlapBox;
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> fftSizeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> overlapAttachment;
+
+    // Phase mode, linear-phase quality, oversampling and peak design
+    juce::ComboBox phaseModeBox, qualityBox, oversamplingBox, peakDesignBox;
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> phaseModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> qualityAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> peakDesignAttachment;
+
+    // Points the controls at a different band's parameters
+    void attachToBand (size_t bandIndex);
+
+    // Preset bank: load or extend a bank, pick presets A and B, and morph between them
+    juce::TextButton bankButton { "Bank" };
+    juce::ComboBox   presetABox, presetBBox;
+    juce::Slider     morphSlider;
+
+    std::unique_ptr<juce::FileChooser> bankChooser;
+
+    void showBankMenu();
+    void chooseBankFile (bool addCurrentSettings);
+    void addCurrentSettingsToBank (const juce::File& file);
+    void refreshPresetBoxes();
+    void syncPresetControls();
+    void sendPresetMorph();
+
+    // Number of the analyser frame currently on screen
+    juce::uint64 lastPaintedFrame = 0;
+
+    // Scope layout, worked out in resized(). Per-frame repaints cover scopeArea only.
+    juce::Rectangle<int> scopeArea, spectrumArea, waterfallArea;
+
+    // Window background, title and scope grid, drawn at the display scale.
+    // Cleared in resized() and redrawn by the next paint().
+    juce::Image backgroundCache;
+    float       backgroundScale = 0.0f;
+
+    void renderBackground (float scale);
+
+   #if SPECTRALEQ_SHOW_PAINT_TIME
+    double averagePaintMs = 0.0;
+   #endif
 
-    // And each slider has an attachment to the APVTS parameters
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band1FreqAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band1GainAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band1QAttachment;
+   #if SPECTRALEQ_ENABLE_PROFILING
+    // The processor's DSP load, top left of the spectrum
+    void paintLoadReadout (juce::Graphics& g);
+   #endif
 
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band2FreqAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band2GainAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band2QAttachment;
+    // Spectrum line on a log frequency axis; the path is kept to reuse its storage
+    LogFrequencyAxis spectrumAxis;
+    juce::Path       spectrumPath;
 
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band3FreqAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band3GainAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> band3QAttachment;
+    WaterfallDisplay waterfall;
 
     // Called ~30 times/sec to refresh the spectrogram
     void timerCallback() override;
@@ -6,29 +6,100 @@ SpectralEQAudioProcessor::SpectralEQAudioProcessor()
     : AudioProcessor (BusesProperties()
                         .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                         .withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
-      apvts (*this, nullptr, "Parameters", createParameterLayout())
+      apvts (*this, nullptr, "Parameters", createParameterLayout()),
+      binaryState (getParameters())
 {
-    // Clear FFT buffers
-    fftData.fill (0.0f);
-    scopeData.fill (0.0f);
-    fifo.fill (0.0f);
-
     // Link parameter references for each band
-    band1.freqParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band1Freq"));
-    band1.gainParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band1Gain"));
-    band1.qParam    = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band1Q"));
+    for (size_t i = 0; i < maxBands; ++i)
+    {
+        auto& band = bands[i];
+        band.freqParam    = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter (getBandParameterID (i, "Freq")));
+        band.gainParam    = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter (getBandParameterID (i, "Gain")));
+        band.qParam       = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter (getBandParameterID (i, "Q")));
+        band.enabledParam = dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter (getBandParameterID (i, "On")));
+        band.channelParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter (getBandParameterID (i, "Channel")));
+        band.modParam     = dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter (getBandParameterID (i, "Mod")));
+    }
+
+    // Listen for changes so the audio thread only redesigns bands that moved
+    bandForParameterIndex.assign ((size_t) getParameters().size(), -1);
+
+    for (size_t i = 0; i < maxBands; ++i)
+    {
+        for (auto* param : { static_cast<juce::AudioProcessorParameter*> (bands[i].freqParam),
+                             static_cast<juce::AudioProcessorParameter*> (bands[i].gainParam),
+                             static_cast<juce::AudioProcessorParameter*> (bands[i].qParam),
+                             static_cast<juce::AudioProcessorParameter*> (bands[i].enabledParam),
+                             static_cast<juce::AudioProcessorParameter*> (bands[i].channelParam),
+                             static_cast<juce::AudioProcessorParameter*> (bands[i].modParam) })
+        {
+            bandForParameterIndex[(size_t) param->getParameterIndex()] = (int) i;
+            param->addListener (this);
+        }
+    }
+
+    // Analyser settings
+    fftOrderParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter ("FFTOrder"));
+    overlapParam  = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter ("Overlap"));
 
-    band2.freqParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band2Freq"));
-    band2.gainParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band2Gain"));
-    band2.qParam    = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band2Q"));
+    fftOrderParam->addListener (this);
+    overlapParam->addListener (this);
 
-    band3.freqParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band3Freq"));
-    band3.gainParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band3Gain"));
-    band3.qParam    = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter ("Band3Q"));
+    analyser.setFFTOrder (SpectrumAnalyser::minFFTOrder + fftOrderParam->getIndex());
+    analyser.setOverlap (overlapParam->getIndex());
+
+    // Phase mode
+    phaseModeParam     = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter ("PhaseMode"));
+    linearQualityParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter ("LinearQuality"));
+
+    phaseModeParam->addListener (this);
+    linearQualityParam->addListener (this);
+
+    linearPhase.setActive (isLinearPhase());
+    linearPhase.setQuality (linearQualityParam->getIndex());
+
+    // Oversampling and peak design
+    oversamplingParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter ("Oversampling"));
+    oversamplingParam->addListener (this);
+
+    peakDesignParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter ("PeakDesign"));
+    peakDesignParam->addListener (this);
+
+    wantedOversamplingOrder.store (chooseOversamplingOrder());
+
+    // Frequency modulation; the source decides which bands leave the cascade
+    modSourceParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter ("ModSource"));
+    modRateParam   = dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("ModRate"));
+    modDepthParam  = dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("ModDepth"));
+
+    modSourceParam->addListener (this);
+
+    // Presets recalled on the audio thread, and latency changes, are reported from here
+    unannouncedParameters = std::make_unique<std::atomic<bool>[]> ((size_t) getParameters().size());
+    startTimerHz (20);
 }
 
 SpectralEQAudioProcessor::~SpectralEQAudioProcessor()
 {
+    stopTimer();
+
+    for (auto& band : bands)
+    {
+        band.freqParam->removeListener (this);
+        band.gainParam->removeListener (this);
+        band.qParam->removeListener (this);
+        band.enabledParam->removeListener (this);
+        band.channelParam->removeListener (this);
+        band.modParam->removeListener (this);
+    }
+
+    fftOrderParam->removeListener (this);
+    overlapParam->removeListener (this);
+    phaseModeParam->removeListener (this);
+    linearQualityParam->removeListener (this);
+    oversamplingParam->removeListener (this);
+    peakDesignParam->removeListener (this);
+    modSourceParam->removeListener (this);
 }
 
 //==============================================================================
@@ -37,88 +108,270 @@ void SpectralEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerB
     juce::dsp::ProcessSpec spec;
     spec.sampleRate       = sampleRate;
     spec.maximumBlockSize = (juce::uint32) samplesPerBlock;
-    spec.numChannels      = 2;
+    spec.numChannels      = (juce::uint32) juce::jlimit (1, maxChannels, getMainBusNumOutputChannels());
+
+    // Both precisions are kept ready; the host may switch between prepareToPlay() calls
+    floatEngine.prepare (spec);
+    doubleEngine.prepare (spec);
+    modulator.prepare (sampleRate, samplesPerBlock);
+
+   #if SPECTRALEQ_ENABLE_PROFILING
+    loadMonitor.prepare (sampleRate);
+   #endif
 
-    filterChain.prepare (spec);
-    updateFilterChain();
+    // The sample rate may have changed, so every band needs redesigning
+    for (auto& smoothing : bandSmoothing)
+        smoothing.reset (sampleRate / controlInterval);
 
-    // Reset the FIFO & flags
-    fifoIndex         = 0;
-    nextFFTBlockReady = false;
-    fifo.fill (0.0f);
+    samplesUntilControlPoint = 0;
+
+    wantedOversamplingOrder.store (chooseOversamplingOrder());
+    oversamplingOrder = wantedOversamplingOrder.load();
+    updateFilterChain (true);
+
+    silentSamples  = 0;
+    filtersSkipped = false;
+    idleBlocks.store (0);
+
+    // Builds the first linear-phase kernel from the sections passed above
+    linearPhase.prepare (sampleRate, (int) spec.numChannels);
+    linearPhaseRunning = isLinearPhase();
+    updateLatency();
+
+    // Restart the analysis thread with an empty ring
+    if (analyserEnabled.load())
+        analyser.start (sampleRate);
+    else
+        analyser.stop();
 }
 
 void SpectralEQAudioProcessor::releaseResources()
 {
-    // Nothing special here
+    analyser.stop();
+    linearPhase.release();
 }
 
 bool SpectralEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    // We only allow stereo in/out
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-    if (layouts.getMainInputChannelSet()  != juce::AudioChannelSet::stereo())
+    // Any layout from mono to maxChannels, the same on both sides
+    const auto& output = layouts.getMainOutputChannelSet();
+
+    if (output.isDisabled() || output.size() > maxChannels)
         return false;
 
-    return true;
+    return layouts.getMainInputChannelSet() == output;
 }
 
 //==============================================================================
 void SpectralEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                              juce::MidiBuffer& midiMessages)
 {
-    // We don't use midiMessages in this plugin
-    (void) midiMessages;
+    // MIDI notes can drive the modulation; the buffer is passed through untouched
+    processSamples (buffer, midiMessages);
+}
+
+void SpectralEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer,
+                                             juce::MidiBuffer& midiMessages)
+{
+    processSamples (buffer, midiMessages);
+}
+
+template <typename SampleType>
+void SpectralEQAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi)
+{
+    // Decaying filter tails must never reach the denormal slow path
+    juce::ScopedNoDenormals noDenormals;
 
-    // Update EQ filters in case parameters changed
-    updateFilterChain();
+    auto& engine = getEngine<SampleType>();
+    const auto numSamples = buffer.getNumSamples();
 
-    // Run the filter chain
-    juce::dsp::AudioBlock<float> block (buffer);
-    juce::dsp::ProcessContextReplacing<float> context (block);
-    filterChain.process (context);
+    SPECTRALEQ_PROFILE_BLOCK (loadMonitor, numSamples);
 
-    // --- FFT for real-time spectrogram (left channel) ---
-    auto* leftChannelData = buffer.getReadPointer(0);
-    for (int i = 0; i < buffer.getNumSamples(); ++i)
+    // Redesign only the bands whose parameters changed since the last block
     {
-        fifo[static_cast<size_t>(fifoIndex)] = leftChannelData[i];
-        fifoIndex++;
+        SPECTRALEQ_PROFILE_SECTION (loadMonitor, coefficients);
 
-        if (fifoIndex == fftSize)
+        // Program changes recall presets from the loaded bank; a new selection sets the parameters first.
+        // The raw bytes are checked, as building a juce::MidiMessage for a long SysEx would allocate.
+        for (const auto metadata : midi)
+            if (metadata.numBytes == 2 && (metadata.data[0] & 0xf0) == 0xc0)
+                selectPreset (metadata.data[1] & 0x7f);
+
+        applyPresetSelection();
+        updateFilterChain();
+    }
+
+    // Switching paths starts the new one from clean state rather than from a stale history
+    if (const auto linear = isLinearPhase(); linear != linearPhaseRunning)
+    {
+        linearPhaseRunning = linear;
+        silentSamples = 0;
+
+        if (linear)
+        {
+            linearPhase.reset();
+        }
+        else
+        {
+            // The bands didn't glide while the FIR ran
+            engine.reset (oversamplingOrder);
+            updateFilterChain (true);
+            samplesUntilControlPoint = 0;
+        }
+    }
+
+    // The modulation follows the input and the notes even through blocks the filters skip
+    const float* modulation = nullptr;
+
+    {
+        SPECTRALEQ_PROFILE_SECTION (loadMonitor, coefficients);
+        modulator.setParameters ((FrequencyModulator::Source) modSourceParam->getIndex(), modRateParam->get(), modDepthParam->get());
+        modulation = modulator.process (buffer, midi);
+    }
+
+    // Silent input into filters that have rung out gives silent output: leave the block alone.
+    // Offline renders always filter, so their output doesn't depend on where the blocks fall.
+    silentSamples = (! isNonRealtime() && isSilent (buffer)) ? silentSamples + numSamples : 0;
+
+    if (silentSamples > 0 && hasRungOut<SampleType> (numSamples))
+    {
+        // What the filters still hold is below the threshold; clear it rather than let it resume with the audio
+        if (! filtersSkipped && ! linearPhaseRunning)
+            engine.reset (oversamplingOrder);
+
+        filtersSkipped = true;
+        idleBlocks.fetch_add (1, std::memory_order_relaxed);
+    }
+    else
+    {
+        filtersSkipped = false;
+
+        // Run all bands in a single pass
+        juce::dsp::AudioBlock<SampleType> block (buffer);
+
+        if (linearPhaseRunning)
+        {
+            SPECTRALEQ_PROFILE_SECTION (loadMonitor, filter);
+            linearPhase.process (juce::dsp::ProcessContextReplacing<SampleType> (block));
+        }
+        else
         {
-            fifoIndex         = 0;
-            nextFFTBlockReady = true;
+            processMinimumPhase (block, modulation);
         }
     }
 
-    if (nextFFTBlockReady)
+    // --- Hand the first channel to the spectrogram's analysis thread, if anyone is looking ---
+    // Once a whole window of the largest FFT has seen silence, more of it wouldn't change the display
+    if (analyserEnabled.load (std::memory_order_relaxed)
+         && analyser.hasConsumers()
+         && silentSamples <= (1 << SpectrumAnalyser::maxFFTOrder))
     {
-        // Window the data
-        window.multiplyWithWindowingTable (fifo.data(), fftSize);
+        SPECTRALEQ_PROFILE_SECTION (loadMonitor, analyser);
+        analyser.pushSamples (buffer.getReadPointer (0), numSamples);
+    }
+}
 
-        // Copy real samples -> fftData; zero out imaginary part
-        std::copy (fifo.begin(), fifo.end(), fftData.begin());
-        std::fill (fftData.begin() + fftSize, fftData.end(), 0.0f);
+template <typename SampleType>
+void SpectralEQAudioProcessor::processMinimumPhase (juce::dsp::AudioBlock<SampleType>& block, const float* modulation) noexcept
+{
+    auto& engine = getEngine<SampleType>();
+    const auto numSamples = (int) block.getNumSamples();
 
-        // Forward FFT
-        forwardFFT.performRealOnlyForwardTransform (fftData.data());
+    // Control points fall every controlInterval samples of the stream, not of the block;
+    // with nothing gliding, the rest of the block runs in one go
+    for (int start = 0; start < numSamples;)
+    {
+        if (samplesUntilControlPoint == 0)
+        {
+            SPECTRALEQ_PROFILE_SECTION (loadMonitor, coefficients);
+
+            if (advanceSmoothing())
+                samplesUntilControlPoint = controlInterval;
+        }
+
+        const auto length = samplesUntilControlPoint > 0 ? juce::jmin (numSamples - start, samplesUntilControlPoint)
+                                                         : numSamples - start;
 
-        // Convert to decibels
-        for (size_t i = 0; i < fftSize / 2; ++i)
         {
-            auto real = fftData[i * 2];
-            auto imag = fftData[i * 2 + 1];
-            auto magnitude = std::sqrt (real * real + imag * imag);
-            scopeData[i] = juce::Decibels::gainToDecibels (magnitude);
+            SPECTRALEQ_PROFILE_SECTION (loadMonitor, filter);
+            auto subBlock = block.getSubBlock ((size_t) start, (size_t) length);
+            engine.process (subBlock, oversamplingOrder, modulation != nullptr ? modulation + start : nullptr);
         }
 
-        newDataReady.store (true);
-        nextFFTBlockReady = false;
+        start += length;
+
+        if (samplesUntilControlPoint > 0)
+            samplesUntilControlPoint -= length;
     }
 }
 
+template <typename SampleType>
+bool SpectralEQAudioProcessor::isSilent (const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    if (buffer.hasBeenCleared())
+        return true;
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        if (buffer.getMagnitude (ch, 0, buffer.getNumSamples()) >= (SampleType) silenceThreshold)
+            return false;
+
+    return true;
+}
+
+template <typename SampleType>
+bool SpectralEQAudioProcessor::hasRungOut (int numSamples) const noexcept
+{
+    // Silent samples before this block, already processed
+    const auto flushedSamples = silentSamples - numSamples;
+
+    // The FIR holds its whole length of input, plus the partition being collected
+    if (linearPhaseRunning)
+    {
+        const auto quality = linearQualityParam->getIndex();
+        return flushedSamples >= LinearPhaseEQ::getFIRLength (quality) + LinearPhaseEQ::getPartitionSize (quality);
+    }
+
+    // The bands themselves have decayed
+    const auto& engine = getEngine<SampleType>();
+
+    if (flushedSamples <= 0
+         || engine.cascade.getStateMagnitude()   >= (SampleType) silenceThreshold
+         || engine.modulated.getStateMagnitude() >= (SampleType) silenceThreshold)
+        return false;
+
+    if (oversamplingOrder == 0)
+        return true;
+
+    // The oversampler's half-band filters still hold the last of the audio for their latency, then ring on
+    const auto& oversampler = *engine.oversamplers[(size_t) oversamplingOrder - 1];
+    return flushedSamples >= (juce::int64) std::ceil (oversampler.getLatencyInSamples()) + oversamplerRingSamples;
+}
+
+//==============================================================================
+double SpectralEQAudioProcessor::getTailLengthSeconds() const
+{
+    const auto sampleRate = getSampleRate();
+
+    if (sampleRate <= 0.0)
+        return 0.0;
+
+    if (isLinearPhase())
+    {
+        // The pre-ring is covered by the reported latency; the FIR's second half rings on after it
+        return (double) (LinearPhaseEQ::getFIRLength (linearQualityParam->getIndex()) / 2) / sampleRate;
+    }
+
+    // A peak's ringing decays with a time constant of about Q / (pi f); allow 60 dB of decay
+    double tail = 0.0;
+
+    for (const auto& band : bands)
+        if (band.enabledParam->get() && std::abs (band.gainParam->get()) > 0.01f)
+            tail = juce::jmax (tail, std::log (1000.0) * (double) band.qParam->get()
+                                       / (juce::MathConstants<double>::pi * (double) band.freqParam->get()));
+
+    return tail;
+}
+
 //==============================================================================
 juce::AudioProcessorEditor* SpectralEQAudioProcessor::createEditor()
 {
@@ -129,103 +382,587 @@ juce::AudioProcessorEditor* SpectralEQAudioProcessor::createEditor()
 //==============================================================================
 void SpectralEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // Copy state
-    auto state = apvts.copyState();
-    if (auto xml = state.createXml())
-        copyXmlToBinary (*xml, destData);
+    // Straight from the parameter values; no ValueTree or XML on the way
+    binaryState.save (destData);
 }
 
 void SpectralEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // Restore state
+    // A damaged or newer binary state is ignored rather than half applied
+    if (BinaryState::isBinaryState (data, (size_t) juce::jmax (0, sizeInBytes)))
+    {
+        binaryState.load (data, (size_t) sizeInBytes);
+        return;
+    }
+
+    // Saved as XML by an earlier version
     if (auto xml = getXmlFromBinary (data, sizeInBytes))
         if (xml->hasTagName (apvts.state.getType()))
             apvts.replaceState (juce::ValueTree::fromXml (*xml));
 }
 
 //==============================================================================
+int SpectralEQAudioProcessor::getNumPrograms()
+{
+    // Hosts expect at least one program, even without a bank
+    return loadedBank != nullptr ? juce::jmax (1, loadedBank->getNumPresets()) : 1;
+}
+
+int SpectralEQAudioProcessor::getCurrentProgram()
+{
+    return morphPresetA.load();
+}
+
+void SpectralEQAudioProcessor::setCurrentProgram (int index)
+{
+    selectPreset (index);
+}
+
+const juce::String SpectralEQAudioProcessor::getProgramName (int index)
+{
+    if (loadedBank != nullptr && juce::isPositiveAndBelow (index, loadedBank->getNumPresets()))
+        return loadedBank->getName (index);
+
+    return {};
+}
+
+juce::Result SpectralEQAudioProcessor::loadPresetBank (const juce::File& file)
+{
+    juce::String error;
+    std::shared_ptr<const PresetBank> bank = PresetBank::open (file, binaryState, error);
+
+    if (bank == nullptr)
+        return juce::Result::fail (error);
+
+    loadedBank = bank;
+
+    // The audio thread never reads the slot written here, so the bank this
+    // replaces is released on this thread, not the audio thread
+    presetBanks.getWriteBuffer() = std::move (bank);
+    presetBanks.publish();
+
+    updateHostDisplay (ChangeDetails().withProgramChanged (true));
+    return juce::Result::ok();
+}
+
+void SpectralEQAudioProcessor::selectPreset (int index) noexcept
+{
+    morphPresetA.store (index);
+    morphPosition.store (0.0f);
+    presetSelections.fetch_add (1, std::memory_order_release);
+}
+
+void SpectralEQAudioProcessor::setPresetMorph (int presetA, int presetB, float position) noexcept
+{
+    morphPresetA.store (presetA);
+    morphPresetB.store (presetB);
+    morphPosition.store (juce::jlimit (0.0f, 1.0f, position));
+    presetSelections.fetch_add (1, std::memory_order_release);
+}
+
+void SpectralEQAudioProcessor::applyPresetSelection() noexcept
+{
+    // The selection is read before the bank, so a bank published before a selection is seen with it
+    const auto selection = presetSelections.load (std::memory_order_acquire);
+
+    presetBanks.acquireLatest();
+
+    if (selection == appliedPresetSelection)
+        return;
+
+    appliedPresetSelection = selection;
+
+    // A selection made with no bank loaded is dropped, so a later bank load doesn't recall it
+    const auto& bank = presetBanks.getReadBuffer();
+
+    if (bank == nullptr || bank->getNumPresets() == 0)
+        return;
+
+    const auto lastPreset = bank->getNumPresets() - 1;
+    const auto presetA    = juce::jlimit (0, lastPreset, morphPresetA.load());
+    const auto presetB    = juce::jlimit (0, lastPreset, morphPresetB.load());
+    const auto position   = morphPosition.load();
+
+    // Only parameters that change are set. The bands then glide to their new values like any
+    // other parameter change, so a switch doesn't click.
+    auto anyChanged = false;
+
+    for (size_t i = 0; i < binaryState.getNumParameters(); ++i)
+    {
+        auto& param = binaryState.getParameter (i);
+
+        auto getValue = [&] (int preset)
+        {
+            float plainValue;
+            return bank->getPlainValue (preset, i, plainValue) ? param.convertTo0to1 (plainValue)
+                                                               : param.getDefaultValue();
+        };
+
+        auto value = getValue (presetA);
+
+        if (position > 0.0f)
+        {
+            // Switches and choices can't sit in between; they flip halfway
+            const auto valueB = getValue (presetB);
+            value = param.isDiscrete() || param.isBoolean() ? (position < 0.5f ? value : valueB)
+                                                            : value + (valueB - value) * position;
+        }
+
+        if (value == param.getValue())
+            continue;
+
+        // setValueNotifyingHost() would take the listener lock and call into the host from here, so
+        // the value is set silently, passed to the DSP directly, and announced by dispatchPendingChanges()
+        static_cast<juce::AudioProcessorParameter&> (param).setValue (value);
+
+        // Announcing it later won't find the oversampling order changing any more, so say so now
+        if (handleParameterChange (param.getParameterIndex()))
+            latencyChanged.store (true, std::memory_order_release);
+
+        unannouncedParameters[(size_t) param.getParameterIndex()].store (true, std::memory_order_relaxed);
+        anyChanged = true;
+    }
+
+    if (anyChanged)
+        anyUnannouncedParameters.store (true, std::memory_order_release);
+}
+
+void SpectralEQAudioProcessor::dispatchPendingChanges()
+{
+    // The APVTS, the editor and the host catch up with the recalled values
+    if (anyUnannouncedParameters.exchange (false, std::memory_order_acquire))
+    {
+        const auto& params = getParameters();
+
+        for (int i = 0; i < params.size(); ++i)
+            if (unannouncedParameters[(size_t) i].exchange (false, std::memory_order_relaxed))
+                params[i]->sendValueChangedMessageToListeners (params[i]->getValue());
+    }
+
+    // Switching to linear phase is one of these changes, and the builder sleeps until told
+    if (latencyChanged.exchange (false, std::memory_order_acquire))
+    {
+        linearPhase.wakeBuilder();
+        updateLatency();
+    }
+}
+
+//==============================================================================
+juce::String SpectralEQAudioProcessor::getBandParameterID (size_t bandIndex, const char* suffix)
+{
+    return "Band" + juce::String ((int) bandIndex + 1) + suffix;
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout SpectralEQAudioProcessor::createParameterLayout()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
 
+    // The first three bands keep the original 200 Hz / 1 kHz / 5 kHz layout and
+    // start enabled; the rest start disabled, spread evenly on a log scale.
+    const float defaultFrequencies[] = { 200.0f, 1000.0f, 5000.0f };
+
+    // Each band is linked across all channels, or applies to one channel only
+    juce::StringArray channelChoices { "All" };
+
+    for (int ch = 1; ch <= maxChannels; ++ch)
+        channelChoices.add (juce::String (ch));
+
+    for (size_t i = 0; i < maxBands; ++i)
+    {
+        const auto name             = "Band" + juce::String ((int) i + 1);
+        const auto enabledByDefault = i < std::size (defaultFrequencies);
+        const auto defaultFreq      = enabledByDefault
+                                        ? defaultFrequencies[i]
+                                        : 20.0f * std::pow (1000.0f, ((float) i + 0.5f) / (float) maxBands);
+
+        params.push_back (std::make_unique<juce::AudioParameterFloat>(
+            getBandParameterID (i, "Freq"), name + " Freq",
+             juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.5f), std::round (defaultFreq)));
+        params.push_back (std::make_unique<juce::AudioParameterFloat>(
+            getBandParameterID (i, "Gain"), name + " Gain (dB)",
+             juce::NormalisableRange<float>(-24.0f, 24.0f, 0.1f), 0.0f));
+        params.push_back (std::make_unique<juce::AudioParameterFloat>(
+            getBandParameterID (i, "Q"), name + " Q",
+             juce::NormalisableRange<float>(0.1f, 10.0f, 0.01f), 1.0f));
+        params.push_back (std::make_unique<juce::AudioParameterBool>(
+            getBandParameterID (i, "On"), name + " On", enabledByDefault));
+        params.push_back (std::make_unique<juce::AudioParameterChoice>(
+            getBandParameterID (i, "Channel"), name + " Channel", channelChoices, 0));
+        params.push_back (std::make_unique<juce::AudioParameterBool>(
+            getBandParameterID (i, "Mod"), name + " Mod", false));
+    }
+
     // ======================
-    // Band 1
-    params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band1Freq", "Band1 Freq",
-         juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.5f), 200.0f));
-    params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band1Gain", "Band1 Gain (dB)",
-         juce::NormalisableRange<float>(-24.0f, 24.0f, 0.1f), 0.0f));
-    params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band1Q", "Band1 Q",
-         juce::NormalisableRange<float>(0.1f, 10.0f, 0.01f), 1.0f));
+    // Analyser
+    juce::StringArray fftSizes;
+
+    for (int order = SpectrumAnalyser::minFFTOrder; order <= SpectrumAnalyser::maxFFTOrder; ++order)
+        fftSizes.add (juce::String (1 << order));
+
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        "FFTOrder", "Analyser FFT Size", fftSizes,
+         SpectrumAnalyser::defaultFFTOrder - SpectrumAnalyser::minFFTOrder));
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        "Overlap", "Analyser Overlap", juce::StringArray { "0%", "50%", "75%", "87.5%" },
+         SpectrumAnalyser::defaultOverlapIndex));
 
     // ======================
-    // Band 2
-    params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band2Freq", "Band2 Freq",
-         juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.5f), 1000.0f));
-    params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band2Gain", "Band2 Gain (dB)",
-         juce::NormalisableRange<float>(-24.0f, 24.0f, 0.1f), 0.0f));
-    params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band2Q", "Band2 Q",
-         juce::NormalisableRange<float>(0.1f, 10.0f, 0.01f), 1.0f));
+    // Phase mode. Switching changes the latency, which hosts don't expect to
+    // follow automation, so neither is automatable.
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        "PhaseMode", "Phase Mode", juce::StringArray { "Minimum phase", "Linear phase" }, 0,
+         juce::AudioParameterChoiceAttributes().withAutomatable (false)));
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        "LinearQuality", "Linear Phase Quality", juce::StringArray { "Low latency", "Balanced", "High quality" },
+         LinearPhaseEQ::defaultQuality, juce::AudioParameterChoiceAttributes().withAutomatable (false)));
+
+    // Oversampling around the cascade; Auto only engages it for bands close to Nyquist
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        "Oversampling", "Oversampling", juce::StringArray { "Off", "Auto", "2x", "4x", "8x" }, 1,
+         juce::AudioParameterChoiceAttributes().withAutomatable (false)));
+
+    // Peak design: the RBJ bilinear peak, or one matched to the analog response up to Nyquist
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        "PeakDesign", "Peak Design", juce::StringArray { "Bilinear", "Matched" }, 0));
 
     // ======================
-    // Band 3
-    params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band3Freq", "Band3 Freq",
-         juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.5f), 5000.0f));
+    // Frequency modulation of the bands whose Mod switch is on. Depth is in
+    // octaves; for MIDI notes, a depth of 1 tracks the keyboard exactly.
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        "ModSource", "Mod Source", juce::StringArray { "Off", "LFO", "Envelope", "MIDI note" }, 0));
     params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band3Gain", "Band3 Gain (dB)",
-         juce::NormalisableRange<float>(-24.0f, 24.0f, 0.1f), 0.0f));
+        "ModRate", "Mod Rate (Hz)", juce::NormalisableRange<float>(0.01f, 20.0f, 0.01f, 0.3f), 1.0f));
     params.push_back (std::make_unique<juce::AudioParameterFloat>(
-        "Band3Q", "Band3 Q",
-         juce::NormalisableRange<float>(0.1f, 10.0f, 0.01f), 1.0f));
+        "ModDepth", "Mod Depth (oct)", juce::NormalisableRange<float>(-4.0f, 4.0f, 0.01f), 1.0f));
 
     return { params.begin(), params.end() };
 }
 
 //==============================================================================
-void SpectralEQAudioProcessor::updateFilterChain()
+void SpectralEQAudioProcessor::updateFilterChain (bool forceAll)
 {
-    auto updatePeakFilter = [] (auto& peakFilter, float freq, float gainDb, float Q, double sampleRate)
+    // A new oversampling order means a new design rate for every band
+    if (const auto order = wantedOversamplingOrder.load(); order != oversamplingOrder)
     {
-        auto gainLinear = juce::Decibels::decibelsToGain (gainDb, -60.0f);
-        auto coeffs     = juce::dsp::IIR::Coefficients<float>::makePeakFilter (sampleRate,
-                                                                               freq,
-                                                                               Q,
-                                                                               gainLinear);
-        *peakFilter.state = *coeffs;
+        oversamplingOrder = order;
+        forceAll = true;
+
+        floatEngine.reset (order);
+        doubleEngine.reset (order);
+    }
+
+    // Coefficients are designed on the stack and copied into the cascade,
+    // so nothing here touches the heap.
+    bool anyChanged = forceAll;
+
+    for (size_t i = 0; i < maxBands; ++i)
+    {
+        const auto generation = bandGenerations[i].load (std::memory_order_acquire);
+
+        if (! forceAll && generation == appliedGenerations[i])
+            continue;
+
+        appliedGenerations[i] = generation;
+        anyChanged = true;
+
+        const auto& band      = bands[i];
+        const auto  enabled   = band.enabledParam->get();
+        const auto  channel   = band.channelParam->getIndex();
+        const auto  modulated = enabled && isBandModulated (i);
+
+        // A band that just came on, changed channel or moved between the cascade and
+        // the modulated bands has nothing to glide from
+        const auto wasEnabled = floatEngine.cascade.isBandEnabled (i) || floatEngine.modulated.isBandEnabled (i);
+        const auto jump = forceAll || ! wasEnabled || channel != appliedChannels[i] || modulated != appliedModulation[i];
+
+        appliedChannels[i]   = channel;
+        appliedModulation[i] = modulated;
+
+        floatEngine.cascade.setBandEnabled (i, enabled && ! modulated);
+        doubleEngine.cascade.setBandEnabled (i, enabled && ! modulated);
+        floatEngine.modulated.setBandEnabled (i, modulated);
+        doubleEngine.modulated.setBandEnabled (i, modulated);
+
+        if (! jump)
+        {
+            // The next control point starts the glide
+            bandSmoothing[i].setTargetValues (band);
+        }
+        else
+        {
+            bandSmoothing[i].setCurrentAndTargetValues (band);
+
+            if (enabled)
+                applyBandCoefficients (i, false);
+        }
+    }
+
+    if (! anyChanged)
+        return;
+
+    // The linear-phase builder designs one FIR, for all channels, from the enabled linked sections.
+    // Its kernel crossfade smooths changes already, so it gets the targets straight away.
+    std::array<BiquadCoefficients<float>, maxBands> sections;
+    size_t numSections = 0;
+
+    for (size_t i = 0; i < maxBands; ++i)
+    {
+        const auto& band = bands[i];
+
+        if (band.enabledParam->get() && band.channelParam->getIndex() == 0)
+            sections[numSections++] = designBand (band.freqParam->get(), band.gainParam->get(), band.qParam->get()).withType<float>();
+    }
+
+    linearPhase.setSections (sections.data(), numSections, (double) (1 << oversamplingOrder));
+}
+
+BiquadCoefficients<double> SpectralEQAudioProcessor::designBand (float freq, float gainDecibels, float q) const noexcept
+{
+    const auto sampleRate = getSampleRate() * (1 << oversamplingOrder);
+    const auto gainLinear = juce::Decibels::decibelsToGain (gainDecibels, -60.0f);
+
+    return isMatchedDesign() ? BiquadCoefficients<double>::makeMatchedPeak (sampleRate, freq, q, gainLinear)
+                             : BiquadCoefficients<double>::makePeak (sampleRate, freq, q, gainLinear);
+}
+
+void SpectralEQAudioProcessor::applyBandCoefficients (size_t bandIndex, bool ramp) noexcept
+{
+    const auto& smoothing = bandSmoothing[bandIndex];
+
+    // A modulated band designs its own coefficients every sample, around these values
+    if (appliedModulation[bandIndex])
+    {
+        const auto octave = PeakCoefficientTable::toOctave (smoothing.freq.getCurrentValue(), getSampleRate() * (1 << oversamplingOrder));
+        const auto shape  = PeakCoefficientTable::makeShape (smoothing.q.getCurrentValue(),
+                                                             juce::Decibels::decibelsToGain (smoothing.gainDecibels.getCurrentValue(), -60.0f));
+
+        if (ramp)
+        {
+            floatEngine.modulated.setBandTarget (bandIndex, octave, shape);
+            doubleEngine.modulated.setBandTarget (bandIndex, octave, shape);
+        }
+        else
+        {
+            floatEngine.modulated.setBand (bandIndex, octave, shape, appliedChannels[bandIndex] - 1);
+            doubleEngine.modulated.setBand (bandIndex, octave, shape, appliedChannels[bandIndex] - 1);
+        }
+
+        return;
+    }
+
+    const auto coefficients = designBand (smoothing.freq.getCurrentValue(),
+                                          smoothing.gainDecibels.getCurrentValue(),
+                                          smoothing.q.getCurrentValue());
+
+    const auto channel = appliedChannels[bandIndex];
+
+    auto apply = [&] (auto& cascade, const auto& c)
+    {
+        using Coefficients = std::decay_t<decltype (c)>;
+
+        auto set = [&] (auto... args)
+        {
+            if (ramp)
+                cascade.setTargetCoefficients (bandIndex, args...);
+            else
+                cascade.setCoefficients (bandIndex, args...);
+        };
+
+        if (channel == 0)
+        {
+            set (c);
+        }
+        else
+        {
+            // Every other channel passes straight through this band
+            set (Coefficients());
+            set ((size_t) channel - 1, c);
+        }
     };
 
-    double sampleRate = getSampleRate();
+    apply (floatEngine.cascade, coefficients.withType<float>());
+    apply (doubleEngine.cascade, coefficients);
+}
+
+bool SpectralEQAudioProcessor::advanceSmoothing() noexcept
+{
+    bool anyGliding = false;
+
+    for (size_t i = 0; i < maxBands; ++i)
+    {
+        auto& smoothing = bandSmoothing[i];
+
+        if (! (floatEngine.cascade.isBandEnabled (i) || floatEngine.modulated.isBandEnabled (i)) || ! smoothing.isSmoothing())
+            continue;
+
+        smoothing.advance();
+        applyBandCoefficients (i, true);
+        anyGliding = true;
+    }
+
+    // The engines run at the oversampled rate, so their ramp is that much longer
+    if (anyGliding)
+    {
+        const auto rampLength = (size_t) controlInterval << oversamplingOrder;
+        floatEngine.cascade.startRamp (rampLength);
+        doubleEngine.cascade.startRamp (rampLength);
+        floatEngine.modulated.startRamp (rampLength);
+        doubleEngine.modulated.startRamp (rampLength);
+    }
+
+    return anyGliding;
+}
+
+//==============================================================================
+void SpectralEQAudioProcessor::BandSmoothing::reset (double controlRate)
+{
+    freq.reset (controlRate, smoothingSeconds);
+    q.reset (controlRate, smoothingSeconds);
+    gainDecibels.reset (controlRate, smoothingSeconds);
+}
+
+void SpectralEQAudioProcessor::BandSmoothing::setCurrentAndTargetValues (const BandParameters& band) noexcept
+{
+    freq.setCurrentAndTargetValue (band.freqParam->get());
+    q.setCurrentAndTargetValue (band.qParam->get());
+    gainDecibels.setCurrentAndTargetValue (band.gainParam->get());
+}
+
+void SpectralEQAudioProcessor::BandSmoothing::setTargetValues (const BandParameters& band) noexcept
+{
+    freq.setTargetValue (band.freqParam->get());
+    q.setTargetValue (band.qParam->get());
+    gainDecibels.setTargetValue (band.gainParam->get());
+}
+
+bool SpectralEQAudioProcessor::BandSmoothing::isSmoothing() const noexcept
+{
+    return freq.isSmoothing() || q.isSmoothing() || gainDecibels.isSmoothing();
+}
+
+void SpectralEQAudioProcessor::BandSmoothing::advance() noexcept
+{
+    freq.getNextValue();
+    q.getNextValue();
+    gainDecibels.getNextValue();
+}
+
+void SpectralEQAudioProcessor::parameterValueChanged (int parameterIndex, float newValue)
+{
+    (void) newValue;
+
+    // May be called from any thread (including the audio thread during automation), so a
+    // latency change is only flagged here; posting a message from the audio thread could lock
+    if (handleParameterChange (parameterIndex))
+        latencyChanged.store (true, std::memory_order_release);
+}
+
+bool SpectralEQAudioProcessor::handleParameterChange (int parameterIndex) noexcept
+{
+    auto isBandParameter = false;
+    auto latencyMayChange = false;
+
+    if (juce::isPositiveAndBelow (parameterIndex, (int) bandForParameterIndex.size()))
+    {
+        if (auto band = bandForParameterIndex[(size_t) parameterIndex]; band >= 0)
+        {
+            bandGenerations[(size_t) band].fetch_add (1, std::memory_order_release);
+            isBandParameter = true;
+        }
+    }
+
+    // A new design method redesigns every band, and a new modulation source may move any of them
+    if (parameterIndex == peakDesignParam->getParameterIndex()
+         || parameterIndex == modSourceParam->getParameterIndex())
+    {
+        for (auto& generation : bandGenerations)
+            generation.fetch_add (1, std::memory_order_release);
 
-    // Band 1
+        isBandParameter = true;
+    }
+
+    // The oversampling order only changes when a band crosses a threshold; the latency changes with it
+    if (isBandParameter || parameterIndex == oversamplingParam->getParameterIndex())
     {
-        auto& peak = filterChain.get<0>();
-        updatePeakFilter (peak, band1.freqParam->get(),
-                                band1.gainParam->get(),
-                                band1.qParam->get(),
-                                sampleRate);
+        const auto order = chooseOversamplingOrder();
+
+        if (wantedOversamplingOrder.exchange (order) != order)
+            latencyMayChange = true;
     }
-    // Band 2
+
+    if (parameterIndex == fftOrderParam->getParameterIndex())
+        analyser.setFFTOrder (SpectrumAnalyser::minFFTOrder + fftOrderParam->getIndex());
+
+    if (parameterIndex == overlapParam->getParameterIndex())
+        analyser.setOverlap (overlapParam->getIndex());
+
+    if (parameterIndex == phaseModeParam->getParameterIndex()
+         || parameterIndex == linearQualityParam->getParameterIndex())
+    {
+        linearPhase.setActive (isLinearPhase());
+        linearPhase.setQuality (linearQualityParam->getIndex());
+        latencyMayChange = true;
+    }
+
+    return latencyMayChange;
+}
+
+int SpectralEQAudioProcessor::chooseOversamplingOrder() const noexcept
+{
+    const auto mode = oversamplingParam->getIndex();
+
+    if (mode != 1)
+        return mode == 0 ? 0 : mode - 1;
+
+    const auto sampleRate = getSampleRate();
+
+    if (sampleRate <= 0.0 || isMatchedDesign())
+        return 0;
+
+    // Keep the top of each peak's bandwidth under a quarter of the (oversampled) rate
+    constexpr double maxEdgeProportion = 0.25;
+    double highestEdge = 0.0;
+
+    for (const auto& band : bands)
     {
-        auto& peak = filterChain.get<1>();
-        updatePeakFilter (peak, band2.freqParam->get(),
-                                band2.gainParam->get(),
-                                band2.qParam->get(),
-                                sampleRate);
+        if (! band.enabledParam->get() || std::abs (band.gainParam->get()) <= 0.01f)
+            continue;
+
+        const auto halfBandwidth = 1.0 / (2.0 * (double) band.qParam->get());
+        highestEdge = juce::jmax (highestEdge, (double) band.freqParam->get()
+                                                 * (std::sqrt (1.0 + halfBandwidth * halfBandwidth) + halfBandwidth));
     }
-    // Band 3
+
+    for (int order = 0; order < maxOversamplingOrder; ++order)
+        if (highestEdge <= maxEdgeProportion * sampleRate * (double) (1 << order))
+            return order;
+
+    return maxOversamplingOrder;
+}
+
+void SpectralEQAudioProcessor::updateLatency()
+{
+    if (isLinearPhase())
     {
-        auto& peak = filterChain.get<2>();
-        updatePeakFilter (peak, band3.freqParam->get(),
-                                band3.gainParam->get(),
-                                band3.qParam->get(),
-                                sampleRate);
+        setLatencySamples (LinearPhaseEQ::getLatencySamples (linearQualityParam->getIndex()));
+        return;
     }
+
+    setLatencySamples (getOversamplingLatency (wantedOversamplingOrder.load()));
+}
+
+int SpectralEQAudioProcessor::getRequiredLatencySamples() const noexcept
+{
+    if (isLinearPhase())
+        return LinearPhaseEQ::getLatencySamples (linearQualityParam->getIndex());
+
+    return getOversamplingLatency (chooseOversamplingOrder());
+}
+
+int SpectralEQAudioProcessor::getOversamplingLatency (int order) const noexcept
+{
+    const auto* oversampler = order > 0 ? floatEngine.oversamplers[(size_t) order - 1].get() : nullptr;
+    return oversampler != nullptr ? (int) std::ceil (oversampler->getLatencyInSamples()) : 0;
 }
 
 //==============================================================================
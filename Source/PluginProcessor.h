@@ -1,25 +1,42 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BiquadCascade.h"
+#include "SpectrumAnalyser.h"
+#include "LinearPhaseEQ.h"
+#include "ModulatedBands.h"
+#include "FrequencyModulator.h"
+#include "DSPLoadMonitor.h"
+#include "BinaryState.h"
+#include "PresetBank.h"
+#include "TripleBuffer.h"
 
 /**
-    A simple struct to hold references to the three parameters
-    for each EQ band: Frequency, Gain (in dB), and Q (resonance).
+    A simple struct to hold references to the parameters for each EQ band:
+    Frequency, Gain (in dB), Q (resonance), whether the band is enabled,
+    which channel it applies to (index 0 = all channels, linked) and whether
+    its frequency follows the modulation source.
 */
 struct BandParameters
 {
-    juce::AudioParameterFloat* freqParam = nullptr;
-    juce::AudioParameterFloat* gainParam = nullptr;
-    juce::AudioParameterFloat* qParam    = nullptr;
+    juce::AudioParameterFloat* freqParam    = nullptr;
+    juce::AudioParameterFloat* gainParam    = nullptr;
+    juce::AudioParameterFloat* qParam       = nullptr;
+    juce::AudioParameterBool*  enabledParam = nullptr;
+    juce::AudioParameterChoice* channelParam = nullptr;
+    juce::AudioParameterBool*  modParam     = nullptr;
 };
 
 //==============================================================================
 /**
     A processor that:
-    1) Applies a 3-band parametric EQ using JUCE’s dsp module.
+    1) Applies an N-band parametric EQ (up to maxBands peaks), either as a
+       minimum-phase biquad cascade or as a linear-phase FIR.
     2) Displays a real-time FFT-based spectrogram in the Editor.
 */
-class SpectralEQAudioProcessor  : public juce::AudioProcessor
+class SpectralEQAudioProcessor  : public juce::AudioProcessor,
+                                  private juce::AudioProcessorParameter::Listener,
+                                  private juce::Timer
 {
 public:
     //==============================================================================
@@ -35,6 +52,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    /** Both precisions run natively; see FilterEngine. */
+    bool supportsDoublePrecisionProcessing() const override     { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -42,21 +63,17 @@ public:
 
     //==============================================================================
     const juce::String getName() const override         { return JucePlugin_Name; }
-    bool acceptsMidi() const override                   { return false; }
+    bool acceptsMidi() const override                   { return true; }
     bool producesMidi() const override                  { return false; }
     bool isMidiEffect() const override                  { return false; }
-    double getTailLengthSeconds() const override        { return 0.0; }
+    double getTailLengthSeconds() const override;
 
     //==============================================================================
-    // We only provide 1 dummy program, so these methods ignore their parameters.
-    int getNumPrograms() override                       { return 1; }
-    int getCurrentProgram() override                    { return 0; }
-    void setCurrentProgram (int index) override         { (void)index; }
-    const juce::String getProgramName (int index) override
-    {
-        (void)index;
-        return {};
-    }
+    // The host's programs are the presets of the loaded bank, if any
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
     void changeProgramName (int index, const juce::String& newName) override
     {
         (void)index;
@@ -64,6 +81,10 @@ public:
     }
 
     //==============================================================================
+    /**
+        The state is saved as a BinaryState. States saved as XML by earlier
+        versions still load.
+    */
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
@@ -71,42 +92,348 @@ public:
     /** Holds all plugin parameters (EQ bands, etc.). */
     juce::AudioProcessorValueTreeState apvts;
 
+    /** Number of EQ bands; the first three are enabled by default. */
+    static constexpr size_t maxBands = 24;
+
+    /** Any main bus layout from mono up to this many channels is accepted (e.g. 7.1.4 or 9.1.6). */
+    static constexpr int maxChannels = 16;
+
+    /** Returns e.g. "Band3Freq" for bandIndex 2 and suffix "Freq". */
+    static juce::String getBandParameterID (size_t bandIndex, const char* suffix);
+
+    //==============================================================================
+    /**
+        Background FFT analysis of the output for the spectrogram. Only runs
+        while something has registered with analyser.addConsumer(); otherwise
+        processBlock() just filters.
+    */
+    SpectrumAnalyser analyser;
+
+    /**
+        Turns the analyser off for headless use (benchmarks, offline rendering).
+        While it's off, processBlock() doesn't feed it and prepareToPlay()
+        doesn't start its thread.
+    */
+    void setAnalyserEnabled (bool shouldBeEnabled) noexcept     { analyserEnabled.store (shouldBeEnabled); }
+
+    /**
+        The number of blocks since prepareToPlay() that skipped the filters
+        because the input was silent and every filter had already rung out.
+    */
+    juce::uint64 getNumIdleBlocks() const noexcept              { return idleBlocks.load (std::memory_order_relaxed); }
+
     //==============================================================================
-    /** 
-        FFT-related constants and buffers.
-        We do a 1024-point FFT for visualization only.
+    /**
+        Message thread: maps a preset bank and makes it the one the preset
+        selection refers to. The parameters don't change until a preset is
+        selected.
+    */
+    juce::Result loadPresetBank (const juce::File& file);
+
+    /** Message thread: the bank loaded last, or nullptr. */
+    std::shared_ptr<const PresetBank> getPresetBank() const     { return loadedBank; }
+
+    /**
+        Any thread, the audio thread included: recalls a preset of the loaded
+        bank as preset A, with the morph position at A. MIDI program changes
+        call this too. Wait-free; the recall happens at the start of the next
+        block, and is dropped if no bank is loaded by then.
+    */
+    void selectPreset (int index) noexcept;
+
+    /**
+        Any thread: picks the two presets to morph between and how far
+        between them to sit, 0 for presetA and 1 for presetB. Wait-free.
+    */
+    void setPresetMorph (int presetA, int presetB, float position) noexcept;
+
+    int   getSelectedPreset (bool presetB) const noexcept       { return (presetB ? morphPresetB : morphPresetA).load(); }
+    float getPresetMorphPosition() const noexcept               { return morphPosition.load(); }
+
+    /**
+        Message thread: announces parameter values recalled on the audio thread
+        and reports any latency change to the host. A timer does this 20 times
+        a second; headless tools without a message loop can call it directly.
+    */
+    void dispatchPendingChanges();
+
+    /**
+        The latency the current parameter values call for. Once
+        dispatchPendingChanges() has run, getLatencySamples() should match it.
     */
-    static constexpr size_t fftOrder = 10;  // 2^10 = 1024
-    static constexpr size_t fftSize  = 1 << fftOrder;
+    int getRequiredLatencySamples() const noexcept;
 
-    std::array<float, fftSize * 2> fftData;  // Real + Imag
-    std::array<float, fftSize>     scopeData; // Decibel magnitudes for the UI
-    std::atomic<bool> newDataReady { false };
+   #if SPECTRALEQ_ENABLE_PROFILING
+    /**
+        How much of each block's real-time budget processBlock() takes, in
+        total and for the filters, the coefficient updates and the analyser.
+        Safe to query from any thread.
+    */
+    DSPLoadMonitor& getLoadMonitor() noexcept                   { return loadMonitor; }
+   #endif
 
 private:
     //==============================================================================
-    /** The 3 parametric EQ bands (using ProcessorDuplicator for stereo). */
-    using Filter    = juce::dsp::IIR::Filter<float>;
-    using Coeffs    = juce::dsp::IIR::Coefficients<float>;
-    using PeakFilter= juce::dsp::ProcessorDuplicator<Filter, Coeffs>;
+    static constexpr int maxOversamplingOrder = 3;
+
+    /**
+        The minimum-phase path for one sample type: all EQ bands as one stereo
+        SIMD cascade (disabled bands are skipped), the frequency-modulated
+        bands after it, and the 2x, 4x and 8x oversamplers around both. The
+        oversamplers are all built for the bus's channel count in prepare(),
+        so switching between them never allocates.
+
+        There is one engine per precision, so the float and double
+        processBlock() share the same code. Both engines get the same
+        coefficients, designed in double.
+    */
+    template <typename SampleType>
+    struct FilterEngine
+    {
+        void prepare (const juce::dsp::ProcessSpec& spec)
+        {
+            cascade.prepare (spec);
+            modulated.prepare (spec);
+
+            // Polyphase IIR half-band stages, with the fractional delay rounded up to whole samples
+            for (int order = 1; order <= maxOversamplingOrder; ++order)
+            {
+                auto& oversampler = oversamplers[(size_t) order - 1];
+                oversampler = std::make_unique<juce::dsp::Oversampling<SampleType>> (
+                    spec.numChannels, (size_t) order, juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR, true, true);
+                oversampler->initProcessing ((size_t) spec.maximumBlockSize);
+            }
+        }
+
+        void reset (int oversamplingOrder) noexcept
+        {
+            cascade.reset();
+            modulated.reset();
+
+            if (oversamplingOrder > 0 && oversamplers[(size_t) oversamplingOrder - 1] != nullptr)
+                oversamplers[(size_t) oversamplingOrder - 1]->reset();
+        }
+
+        // modulation: one value per sample of the block, in octaves, or nullptr
+        void process (juce::dsp::AudioBlock<SampleType>& block, int oversamplingOrder, const float* modulation) noexcept
+        {
+            if (oversamplingOrder == 0)
+            {
+                cascade.process (juce::dsp::ProcessContextReplacing<SampleType> (block));
+                modulated.process (block, modulation, 0);
+                return;
+            }
+
+            // The bands run at the higher rate they were designed for
+            auto& oversampler = *oversamplers[(size_t) oversamplingOrder - 1];
+            auto upsampled = oversampler.processSamplesUp (block);
 
-    // Our chain of 3 parametric peak filters
-    juce::dsp::ProcessorChain<PeakFilter, PeakFilter, PeakFilter> filterChain;
+            cascade.process (juce::dsp::ProcessContextReplacing<SampleType> (upsampled));
+            modulated.process (upsampled, modulation, oversamplingOrder);
+            oversampler.processSamplesDown (block);
+        }
+
+        BiquadCascade<SampleType, maxBands, (size_t) maxChannels> cascade;
+        ModulatedBands<SampleType, maxBands, (size_t) maxChannels> modulated;
+        std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, (size_t) maxOversamplingOrder> oversamplers;
+    };
+
+    FilterEngine<float>  floatEngine;
+    FilterEngine<double> doubleEngine;
+
+    template <typename SampleType>
+    FilterEngine<SampleType>& getEngine() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return floatEngine;
+        else
+            return doubleEngine;
+    }
+
+    template <typename SampleType>
+    const FilterEngine<SampleType>& getEngine() const noexcept
+    {
+        return const_cast<SpectralEQAudioProcessor&> (*this).getEngine<SampleType>();
+    }
+
+    // The body of both processBlock() overloads
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi);
+
+    // Runs the engine between control points, ramping the cascade towards each one
+    template <typename SampleType>
+    void processMinimumPhase (juce::dsp::AudioBlock<SampleType>& block, const float* modulation) noexcept;
 
     // The per-band parameter references
-    BandParameters band1, band2, band3;
+    std::array<BandParameters, maxBands> bands;
+
+    // Maps a parameter index to the band it belongs to (-1 for non-band parameters)
+    std::vector<int> bandForParameterIndex;
+
+    // Analyser settings, forwarded to the analyser whenever they change
+    juce::AudioParameterChoice* fftOrderParam = nullptr;
+    juce::AudioParameterChoice* overlapParam  = nullptr;
 
-    // Updates all filter coefficients from the parameter values
-    void updateFilterChain();
+    std::atomic<bool> analyserEnabled { true };
 
     //==============================================================================
-    /** FIFO for gathering samples for the FFT. */
-    std::array<float, fftSize> fifo;
-    int  fifoIndex         = 0;
-    bool nextFFTBlockReady = false;
+    // Silence detection: a block whose every sample is below -120 dBFS counts as silent
+    static constexpr float silenceThreshold = 1.0e-6f;
+
+    std::atomic<juce::uint64> idleBlocks { 0 };
+    juce::int64 silentSamples = 0;      // audio thread: consecutive silent input samples, this block included
+    bool filtersSkipped = false;        // audio thread: the last block skipped the filters
+
+    // How long the oversampler's half-band filters ring on after their latency, in base-rate samples
+    static constexpr int oversamplerRingSamples = 128;
+
+    template <typename SampleType>
+    static bool isSilent (const juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    // True once the active path would only output silence for silent input
+    template <typename SampleType>
+    bool hasRungOut (int numSamples) const noexcept;
+
+   #if SPECTRALEQ_ENABLE_PROFILING
+    DSPLoadMonitor loadMonitor;
+   #endif
+
+    // Saves and restores every parameter; built once the parameters exist
+    BinaryState binaryState;
+
+    //==============================================================================
+    // Preset banks: loaded on the message thread, handed to the audio thread whole
+    std::shared_ptr<const PresetBank> loadedBank;                   // message thread
+    TripleBuffer<std::shared_ptr<const PresetBank>> presetBanks;    // message thread -> audio thread
+
+    std::atomic<int>   morphPresetA { 0 }, morphPresetB { 0 };
+    std::atomic<float> morphPosition { 0.0f };
+    std::atomic<juce::uint32> presetSelections { 0 };               // bumped by every selection
+    juce::uint32 appliedPresetSelection = 0;                        // audio thread
+
+    // Audio thread: sets the parameters from the selected presets after a new selection
+    void applyPresetSelection() noexcept;
+
+    // Parameters a recall changed that the listeners and host haven't heard about yet
+    std::unique_ptr<std::atomic<bool>[]> unannouncedParameters;
+    std::atomic<bool> anyUnannouncedParameters { false };
+
+    // Set from any thread when the latency may have changed; setLatencySamples() belongs on the message thread
+    std::atomic<bool> latencyChanged { false };
+
+    void timerCallback() override                               { dispatchPendingChanges(); }
+
+    /** The linear-phase path, used instead of the cascade when PhaseMode is "Linear phase". */
+    LinearPhaseEQ linearPhase;
+
+    juce::AudioParameterChoice* phaseModeParam     = nullptr;
+    juce::AudioParameterChoice* linearQualityParam = nullptr;
+
+    // Audio thread: which path processed the last block, so a switch starts from clean state
+    bool linearPhaseRunning = false;
+
+    bool isLinearPhase() const noexcept     { return phaseModeParam->getIndex() == 1; }
+
+    juce::AudioParameterChoice* oversamplingParam = nullptr;
+
+    // Bilinear (RBJ) or matched peak design; matched needs no oversampling near Nyquist
+    juce::AudioParameterChoice* peakDesignParam = nullptr;
+
+    bool isMatchedDesign() const noexcept   { return peakDesignParam->getIndex() == 1; }
+
+    /**
+        Frequency modulation. Bands with their Mod switch on follow the
+        modulation source while it isn't Off: they leave the cascade for the
+        engine's ModulatedBands, which redesigns them every sample from a
+        PeakCoefficientTable (always the bilinear peak). The linear-phase path
+        uses their unmodulated settings.
+    */
+    FrequencyModulator modulator;
+
+    juce::AudioParameterChoice* modSourceParam = nullptr;
+    juce::AudioParameterFloat*  modRateParam   = nullptr;
+    juce::AudioParameterFloat*  modDepthParam  = nullptr;
+
+    bool isBandModulated (size_t bandIndex) const noexcept
+    {
+        return modSourceParam->getIndex() != 0 && bands[bandIndex].modParam->get();
+    }
+
+    // The order the parameters call for (0 = off), and the one the audio thread has designed the bands for
+    std::atomic<int> wantedOversamplingOrder { 0 };
+    int oversamplingOrder = 0;
+
+    /**
+        In Auto, the lowest order at which every audible band's upper edge sits
+        well below Nyquist, where the bilinear transform barely cramps it.
+        Always 0 in Auto with the matched design, which doesn't cramp.
+    */
+    int chooseOversamplingOrder() const noexcept;
+
+    // Reports the latency of the selected path to the host
+    void updateLatency();
+    int getOversamplingLatency (int order) const noexcept;
+
+    /**
+        Versioned parameter snapshot: the parameter listener bumps a band's
+        generation whenever one of its values moves, and the audio thread only
+        recomputes the bands whose generation differs from the one it applied.
+    */
+    std::array<std::atomic<juce::uint32>, maxBands> bandGenerations {};
+    std::array<juce::uint32, maxBands>              appliedGenerations {};
+
+    // Picks up the bands that changed (or all of them if forceAll): they glide there, or jump if forceAll
+    void updateFilterChain (bool forceAll = false);
+
+    //==============================================================================
+    /**
+        Control-rate smoothing. Every controlInterval samples of the stream
+        (whatever the host's block size), the bands that are still gliding take
+        one step along their freq / gain / Q ramps and get redesigned, and the
+        cascade ramps its coefficients linearly to the new design over the next
+        controlInterval samples. So automation never steps the coefficients, and
+        the design cost per sample is the same for 1-sample and 8192-sample
+        blocks. Freq and Q glide on a log scale, gain in dB.
+
+        Enabling a band or moving it to another channel still jumps, as do
+        prepareToPlay(), a new oversampling order and a switch back from the
+        linear-phase path (whose kernel crossfade does its own smoothing).
+    */
+    static constexpr int    controlInterval  = 32;
+    static constexpr double smoothingSeconds = 0.05;
+
+    struct BandSmoothing
+    {
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freq, q;
+        juce::SmoothedValue<float> gainDecibels;
+
+        void reset (double controlRate);
+        void setCurrentAndTargetValues (const BandParameters& band) noexcept;
+        void setTargetValues (const BandParameters& band) noexcept;
+        bool isSmoothing() const noexcept;
+        void advance() noexcept;
+    };
+
+    std::array<BandSmoothing, maxBands> bandSmoothing;
+    std::array<int, maxBands>           appliedChannels {};     // the band's channel choice as last applied (0 = all)
+    std::array<bool, maxBands>          appliedModulation {};   // whether the band was last applied as a modulated one
+
+    int samplesUntilControlPoint = 0;                           // 0: no ramp in progress
+
+    // Designs a peak from smoothed or target values, at the current (oversampled) rate
+    BiquadCoefficients<double> designBand (float freq, float gainDecibels, float q) const noexcept;
+
+    // Gives both engines the band's current smoothed design, at once or as a ramp target
+    void applyBandCoefficients (size_t bandIndex, bool ramp) noexcept;
+
+    // Steps every gliding band to its next control point; false if none was gliding
+    bool advanceSmoothing() noexcept;
+
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int, bool) override {}
 
-    juce::dsp::FFT                 forwardFFT { fftOrder };
-    juce::dsp::WindowingFunction<float> window { fftSize, juce::dsp::WindowingFunction<float>::hann };
+    // Wait-free: passes a new parameter value on to the DSP. Returns true if the latency may have changed.
+    bool handleParameterChange (int parameterIndex) noexcept;
 
     //==============================================================================
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
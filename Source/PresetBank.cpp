@@ -0,0 +1,142 @@
+#include "PresetBank.h"
+
+//==============================================================================
+std::unique_ptr<PresetBank> PresetBank::open (const juce::File& file, const BinaryState& layout, juce::String& error)
+{
+    std::unique_ptr<PresetBank> bank (new PresetBank());
+    bank->file    = file;
+    bank->mapping = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+
+    const auto* bytes = static_cast<const juce::uint8*> (bank->mapping->getData());
+    const auto size   = bank->mapping->getSize();
+
+    if (bytes == nullptr)
+    {
+        error = "Can't open " + file.getFullPathName();
+        return nullptr;
+    }
+
+    if (size < headerSize || juce::ByteOrder::littleEndianInt (bytes) != magic)
+    {
+        error = file.getFileName() + " isn't a preset bank";
+        return nullptr;
+    }
+
+    const auto version = juce::ByteOrder::littleEndianShort (bytes + 4);
+    const auto count   = (int) juce::ByteOrder::littleEndianShort (bytes + 6);
+
+    if (version == 0 || version > currentVersion)
+    {
+        error = file.getFileName() + " was saved by a newer version";
+        return nullptr;
+    }
+
+    if (size < headerSize + (size_t) count * entrySize)
+    {
+        error = file.getFileName() + " is truncated";
+        return nullptr;
+    }
+
+    bank->data          = bytes;
+    bank->numPresets    = count;
+    bank->numParameters = layout.getNumParameters();
+    bank->valueOffsets.resize ((size_t) count * bank->numParameters);
+
+    for (int p = 0; p < count; ++p)
+    {
+        const auto* entry = bytes + headerSize + (size_t) p * entrySize;
+        const auto offset = (size_t) juce::ByteOrder::littleEndianInt (entry);
+        const auto length = (size_t) juce::ByteOrder::littleEndianInt (entry + 4);
+        auto* offsets     = bank->valueOffsets.data() + (size_t) p * bank->numParameters;
+
+        if (offset < headerSize || offset > size || length > size - offset
+             || ! layout.locateValues (bytes + offset, length, offsets))
+        {
+            error = "Preset " + juce::String (p + 1) + " in " + file.getFileName() + " is damaged";
+            return nullptr;
+        }
+
+        // Relative to the file from here on
+        for (size_t i = 0; i < bank->numParameters; ++i)
+            if (offsets[i] != 0)
+                offsets[i] += (juce::uint32) offset;
+    }
+
+    return bank;
+}
+
+juce::Result PresetBank::write (const juce::File& file, const juce::StringArray& names,
+                                const juce::Array<juce::MemoryBlock>& states)
+{
+    jassert (names.size() == states.size());
+
+    if (states.size() > 0xffff)
+        return juce::Result::fail ("Too many presets for one bank");
+
+    for (const auto& state : states)
+        if (! BinaryState::isBinaryState (state.getData(), state.getSize()))
+            return juce::Result::fail ("Only binary states can go in a preset bank");
+
+    // Written next to the target and swapped in at the end, so a failed write leaves the old bank alone
+    juce::TemporaryFile temp (file);
+
+    {
+        juce::FileOutputStream out (temp.getFile());
+
+        if (! out.openedOk())
+            return juce::Result::fail ("Can't write " + file.getFullPathName());
+
+        out.writeInt ((int) magic);
+        out.writeShort ((short) currentVersion);
+        out.writeShort ((short) (juce::uint16) states.size());
+
+        auto offset = headerSize + (size_t) states.size() * entrySize;
+
+        for (int p = 0; p < states.size(); ++p)
+        {
+            out.writeInt ((int) offset);
+            out.writeInt ((int) states.getReference (p).getSize());
+            offset += states.getReference (p).getSize();
+
+            // Cut at a character boundary, always leaving a terminating zero
+            auto name = names[p];
+
+            while (name.getNumBytesAsUTF8() >= (size_t) nameSize)
+                name = name.dropLastCharacters (1);
+
+            char field[nameSize] = {};
+            name.copyToUTF8 (field, (size_t) nameSize);
+            out.write (field, (size_t) nameSize);
+        }
+
+        for (const auto& state : states)
+            out.write (state.getData(), state.getSize());
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return out.getStatus();
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return juce::Result::fail ("Can't replace " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+juce::String PresetBank::getName (int preset) const
+{
+    jassert (juce::isPositiveAndBelow (preset, numPresets));
+
+    const auto* name = reinterpret_cast<const char*> (data + headerSize + (size_t) preset * entrySize + 8);
+    return juce::String::fromUTF8 (name, (int) strnlen (name, (size_t) nameSize));
+}
+
+juce::MemoryBlock PresetBank::getState (int preset) const
+{
+    jassert (juce::isPositiveAndBelow (preset, numPresets));
+
+    const auto* entry = data + headerSize + (size_t) preset * entrySize;
+    return { data + juce::ByteOrder::littleEndianInt (entry), (size_t) juce::ByteOrder::littleEndianInt (entry + 4) };
+}
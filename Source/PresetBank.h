@@ -0,0 +1,91 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "BinaryState.h"
+
+//==============================================================================
+/**
+    A file of named presets, memory-mapped read-only, so recalling one reads
+    its values straight out of the mapping.
+
+    Layout, all little-endian:
+
+        offset  size     contents
+        0       4        magic, "SEQK"
+        4       2        format version (currentVersion)
+        6       2        number of presets, n
+        8       48 n     directory: per preset, the offset and size (uint32
+                         each) of its state, then its name (UTF-8, zero-padded
+                         to nameSize bytes)
+        ...              the states, each a complete BinaryState block
+
+    open() checks the whole file once, every preset's CRC included, and works
+    out where each parameter's value sits in each preset. After that the bank
+    never changes, and getPlainValue() is a lookup and a four-byte read, safe
+    for the audio thread. A parameter a preset doesn't store reads as absent,
+    and the caller falls back to its default.
+*/
+class PresetBank
+{
+public:
+    //==============================================================================
+    static constexpr juce::uint16 currentVersion = 1;
+    static constexpr int nameSize = 40;
+
+    /**
+        Maps a bank for the parameters of layout. Returns nullptr, with the
+        reason in error, if the file can't be mapped or anything in it fails
+        its checks.
+    */
+    static std::unique_ptr<PresetBank> open (const juce::File& file, const BinaryState& layout, juce::String& error);
+
+    /** Writes a bank of states saved by getStateInformation(), one per name. */
+    static juce::Result write (const juce::File& file, const juce::StringArray& names,
+                               const juce::Array<juce::MemoryBlock>& states);
+
+    //==============================================================================
+    const juce::File& getFile() const noexcept  { return file; }
+    int getNumPresets() const noexcept          { return numPresets; }
+    juce::String getName (int preset) const;
+
+    /** A copy of the preset's whole state, e.g. to write it into another bank. */
+    juce::MemoryBlock getState (int preset) const;
+
+    /**
+        Audio thread: a parameter's plain value in a preset, with parameters
+        numbered as in the layout the bank was opened for. Returns false if
+        the preset doesn't store that parameter.
+    */
+    bool getPlainValue (int preset, size_t parameterIndex, float& value) const noexcept
+    {
+        jassert (juce::isPositiveAndBelow (preset, numPresets) && parameterIndex < numParameters);
+
+        const auto offset = valueOffsets[(size_t) preset * numParameters + parameterIndex];
+
+        if (offset == 0)
+            return false;
+
+        value = BinaryState::readValue (data + offset);
+        return true;
+    }
+
+private:
+    //==============================================================================
+    static constexpr juce::uint32 magic  = 0x4b514553;     // "SEQK" as a little-endian uint32
+    static constexpr size_t headerSize   = 8;
+    static constexpr size_t entrySize    = 8 + (size_t) nameSize;
+
+    PresetBank() = default;
+
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    const juce::uint8* data = nullptr;
+
+    int numPresets = 0;
+    size_t numParameters = 0;
+
+    // Per preset and parameter: the offset of the value in the file, or 0 if the preset doesn't store it
+    std::vector<juce::uint32> valueOffsets;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
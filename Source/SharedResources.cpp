@@ -0,0 +1,33 @@
+#include "SharedResources.h"
+
+//==============================================================================
+std::shared_ptr<const juce::dsp::FFT> SharedResources::getFFT (int order)
+{
+    return get<juce::dsp::FFT> (order, [order] { return std::make_unique<juce::dsp::FFT> (order); });
+}
+
+std::shared_ptr<const std::vector<float>> SharedResources::getWindow (Window type, int size)
+{
+    return get<std::vector<float>> (std::make_pair (type, size), [type, size]
+    {
+        auto window = std::make_unique<std::vector<float>> ((size_t) size);
+
+        switch (type)
+        {
+            case Window::hann:
+                juce::dsp::WindowingFunction<float>::fillWindowingTables (window->data(), (size_t) size,
+                                                                          juce::dsp::WindowingFunction<float>::hann);
+                break;
+
+            case Window::periodicBlackman:
+                for (int n = 0; n < size; ++n)
+                {
+                    const auto phase = juce::MathConstants<double>::twoPi * (double) n / (double) size;
+                    (*window)[(size_t) n] = (float) (0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2.0 * phase));
+                }
+                break;
+        }
+
+        return window;
+    });
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+
+//==============================================================================
+/**
+    Process-wide registry of the immutable resources every plugin instance
+    would otherwise build for itself: FFT plans, window tables, lookup tables
+    and log-frequency maps.
+
+    Each resource type has its own cache, keyed by whatever the resource is
+    built from (its size, sample rate and so on). The first instance to ask
+    for a key builds the resource; every later one gets the same object,
+    read-only. The caches only hold weak references, so a resource is freed
+    as soon as the last instance using it lets go, and a host that closes
+    every instance gets all the memory back.
+
+    A lookup takes a lock and may build, so only call get() from
+    constructors, prepare calls, background threads or the message thread,
+    never from the audio thread. Using a resource once you have it takes no
+    locking at all.
+*/
+class SharedResources
+{
+public:
+    //==============================================================================
+    /**
+        The shared Resource for key, built with build() (returning a
+        std::unique_ptr<Resource>) if no instance holds one at the moment.
+        Every combination of Resource and Key types has a cache of its own,
+        so give each kind of resource a type of its own too.
+    */
+    template <typename Resource, typename Key, typename Builder>
+    static std::shared_ptr<const Resource> get (const Key& key, Builder&& build)
+    {
+        auto& cache = getCache<Resource, Key>();
+        const juce::ScopedLock sl (cache.lock);
+
+        auto& entry = cache.entries[key];
+
+        if (auto existing = entry.lock())
+            return existing;
+
+        std::shared_ptr<const Resource> resource (build());
+        entry = resource;
+
+        // Forget whatever the last instances have let go of since
+        for (auto it = cache.entries.begin(); it != cache.entries.end();)
+            it = it->second.expired() ? cache.entries.erase (it) : std::next (it);
+
+        return resource;
+    }
+
+    /** The same, for resources that only ever come in one version. */
+    template <typename Resource, typename Builder>
+    static std::shared_ptr<const Resource> get (Builder&& build)
+    {
+        return get<Resource> (0, std::forward<Builder> (build));
+    }
+
+    //==============================================================================
+    /**
+        A real FFT plan of 2^order points. Its transforms are const, but
+        JUCE's fallback engine serialises them with a spin lock, so only share
+        plans between background threads: the audio thread keeps its own.
+    */
+    static std::shared_ptr<const juce::dsp::FFT> getFFT (int order);
+
+    enum class Window
+    {
+        hann,               // juce::dsp::WindowingFunction's, normalised
+        periodicBlackman    // symmetric about size / 2, not normalised
+    };
+
+    /** A window table of size points. */
+    static std::shared_ptr<const std::vector<float>> getWindow (Window type, int size);
+
+private:
+    //==============================================================================
+    template <typename Resource, typename Key>
+    struct Cache
+    {
+        juce::CriticalSection lock;
+        std::map<Key, std::weak_ptr<const Resource>> entries;
+    };
+
+    template <typename Resource, typename Key>
+    static Cache<Resource, Key>& getCache()
+    {
+        static Cache<Resource, Key> cache;
+        return cache;
+    }
+};
@@ -0,0 +1,228 @@
+#include "SpectrumAnalyser.h"
+
+//==============================================================================
+SpectrumAnalyser::SpectrumAnalyser()
+    : juce::Thread ("SpectralEQ Analyser")
+{
+    for (int order = minFFTOrder; order <= maxFFTOrder; ++order)
+    {
+        const auto index = (size_t) (order - minFFTOrder);
+
+        ffts[index]         = SharedResources::getFFT (order);
+        windowTables[index] = SharedResources::getWindow (SharedResources::Window::hann, 1 << order);
+    }
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    stop();
+}
+
+//==============================================================================
+void SpectrumAnalyser::start (double newSampleRate)
+{
+    stop();
+
+    sampleRate = newSampleRate;
+
+    // Safe to reset here: neither the audio thread nor the analysis thread is running
+    ringFifo.reset();
+    historyWritePos = 0;
+    freshSamples    = 0;
+
+    startThread (juce::Thread::Priority::low);
+}
+
+void SpectrumAnalyser::stop()
+{
+    stopThread (1000);
+}
+
+//==============================================================================
+void SpectrumAnalyser::addConsumer()
+{
+    // Everything is sized for the largest FFT so changing size never allocates. Nothing
+    // touches these buffers before the count below goes up, so they're safe to set up here.
+    if (ringBuffer.empty())
+    {
+        ringBuffer.resize ((size_t) ringSize, 0.0f);
+        history.resize (maxFFTSize, 0.0f);
+        fftData.resize (maxFFTSize * 2, 0.0f);
+    }
+
+    if (numConsumers.fetch_add (1, std::memory_order_release) == 0)
+        notify();
+}
+
+void SpectrumAnalyser::removeConsumer() noexcept
+{
+    jassert (numConsumers.load() > 0);
+    numConsumers.fetch_sub (1, std::memory_order_release);
+}
+
+template <typename SampleType>
+void SpectrumAnalyser::pushSamples (const SampleType* samples, int numSamples) noexcept
+{
+    // If the ring is full, whatever doesn't fit is dropped rather than waiting
+    int start1, size1, start2, size2;
+    ringFifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        std::copy_n (samples, size1, ringBuffer.data() + start1);
+
+    if (size2 > 0)
+        std::copy_n (samples + size1, size2, ringBuffer.data() + start2);
+
+    ringFifo.finishedWrite (size1 + size2);
+}
+
+template void SpectrumAnalyser::pushSamples (const float*, int) noexcept;
+template void SpectrumAnalyser::pushSamples (const double*, int) noexcept;
+
+//==============================================================================
+void SpectrumAnalyser::setFFTOrder (int order) noexcept
+{
+    requestedOrder.store (juce::jlimit (minFFTOrder, maxFFTOrder, order));
+}
+
+void SpectrumAnalyser::setOverlap (int overlapIndex) noexcept
+{
+    requestedOverlap.store (juce::jlimit (0, maxOverlapIndex, overlapIndex));
+}
+
+//==============================================================================
+void SpectrumAnalyser::run()
+{
+    while (! threadShouldExit())
+    {
+        // Nobody's looking: drop whatever is still queued and sleep until a consumer registers
+        if (! hasConsumers())
+        {
+            discardQueuedSamples();
+            wait (-1);
+            continue;
+        }
+
+        // Pick up new settings between frames; the history is kept, so a
+        // bigger FFT just looks further back.
+        const auto order   = requestedOrder.load();
+        const auto overlap = requestedOverlap.load();
+
+        if (order != fftOrder || overlap != overlapIndex)
+        {
+            fftOrder     = order;
+            overlapIndex = overlap;
+            samplesUntilNextFrame = juce::jmin (samplesUntilNextFrame, getHopSize());
+        }
+
+        const auto hopSize  = getHopSize();
+        const auto numReady = ringFifo.getNumReady();
+
+        if (numReady < samplesUntilNextFrame)
+        {
+            wait (5);
+            continue;
+        }
+
+        // More than one frame queued: we've fallen behind, so bring the history
+        // up to date without analysing the frames in between.
+        if (numReady >= samplesUntilNextFrame + hopSize)
+        {
+            readIntoHistory (numReady - hopSize);
+            samplesUntilNextFrame = hopSize;
+        }
+
+        readIntoHistory (samplesUntilNextFrame);
+
+        // Even the smallest frame needs a whole window of fresh samples
+        if (freshSamples >= (1 << minFFTOrder))
+            analyseFrame();
+
+        samplesUntilNextFrame = getHopSize();
+    }
+}
+
+void SpectrumAnalyser::discardQueuedSamples() noexcept
+{
+    // The audio thread may still have pushed a block after the last consumer left
+    ringFifo.finishedRead (ringFifo.getNumReady());
+
+    // The history is out of date from here on, so the next consumer gets a fresh warm-up
+    freshSamples = 0;
+    samplesUntilNextFrame = 1 << minFFTOrder;
+}
+
+int SpectrumAnalyser::getFrameOrder() const noexcept
+{
+    auto order = fftOrder;
+
+    while (order > minFFTOrder && (1 << order) > freshSamples)
+        --order;
+
+    return order;
+}
+
+void SpectrumAnalyser::readIntoHistory (int numSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    ringFifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+    auto copyIn = [this] (const float* source, int num)
+    {
+        while (num > 0)
+        {
+            const auto chunk = juce::jmin (num, (int) maxFFTSize - historyWritePos);
+            std::copy_n (source, chunk, history.begin() + historyWritePos);
+
+            historyWritePos = (historyWritePos + chunk) % (int) maxFFTSize;
+            source += chunk;
+            num    -= chunk;
+        }
+    };
+
+    copyIn (ringBuffer.data() + start1, size1);
+    copyIn (ringBuffer.data() + start2, size2);
+    ringFifo.finishedRead (size1 + size2);
+
+    freshSamples = juce::jmin ((int) maxFFTSize, freshSamples + size1 + size2);
+}
+
+void SpectrumAnalyser::analyseFrame() noexcept
+{
+    // While warming up, a smaller FFT than the one selected
+    const auto order   = getFrameOrder();
+    const auto fftSize = 1 << order;
+    const auto index   = (size_t) (order - minFFTOrder);
+
+    // Unwrap the newest fftSize samples from the history into fftData; zero out imaginary part
+    const auto readPos = (historyWritePos - fftSize + (int) maxFFTSize) % (int) maxFFTSize;
+    const auto first   = juce::jmin (fftSize, (int) maxFFTSize - readPos);
+
+    std::copy_n (history.begin() + readPos, first, fftData.begin());
+    std::copy_n (history.begin(), fftSize - first, fftData.begin() + first);
+    std::fill (fftData.begin() + fftSize, fftData.begin() + fftSize * 2, 0.0f);
+
+    // Window the data
+    juce::FloatVectorOperations::multiply (fftData.data(), windowTables[index]->data(), fftSize);
+
+    // Forward FFT
+    ffts[index]->performRealOnlyForwardTransform (fftData.data());
+
+    // Convert to decibels, straight into the next free frame. Magnitudes are
+    // scaled by 2 / fftSize so a full-scale sine reads ~0 dB whatever the size.
+    auto& frame = scopeFrames.getWriteBuffer();
+    const auto numBins = fftSize / 2;
+    const auto scale   = 2.0f / (float) fftSize;
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        auto real = fftData[(size_t) i * 2];
+        auto imag = fftData[(size_t) i * 2 + 1];
+        auto magnitude = std::sqrt (real * real + imag * imag) * scale;
+        frame.decibels[(size_t) i] = juce::Decibels::gainToDecibels (magnitude);
+    }
+
+    frame.numBins    = numBins;
+    frame.sampleRate = sampleRate;
+    scopeFrames.publish();
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+#include "SharedResources.h"
+
+//==============================================================================
+/**
+    Runs the spectrogram FFT on a background thread.
+
+    The audio thread only calls pushSamples(), which copies the block into a
+    wait-free single-producer / single-consumer ring (juce::AbstractFifo) and
+    never blocks or signals anything. The analysis thread polls the ring and
+    keeps a sliding window of the most recent samples. Every hop it windows
+    the newest fftSize samples, runs the FFT and converts the result to
+    decibels. Finished frames are published to the editor through a triple
+    buffer, so the editor never sees a half-written frame and neither side
+    ever waits for the other.
+
+    The FFT order (9..15) and overlap (0..87.5%) can be changed at any time.
+    FFT plans, window tables and buffers for every order are set up front, so
+    switching just selects different ones and never allocates. The plans and
+    window tables come from SharedResources, so every instance in the process
+    uses the same ones; only the buffers are per instance.
+
+    If the analysis thread falls behind (e.g. the machine is saturated) it
+    skips whole frames instead of queueing work, and if the ring is full the
+    audio thread simply drops the samples that don't fit.
+
+    The analysis is demand-driven. Consumers (the editor, normally) register
+    with addConsumer(), and while there are none the audio thread doesn't
+    feed the ring and the analysis thread sleeps without polling. The ring
+    and buffers aren't even allocated until the first consumer arrives. When
+    one does, the thread warms up: until a whole window of the selected size
+    has arrived, each frame uses the largest FFT that the samples received
+    since then fill, starting at 2^minFFTOrder. The display picks up within
+    a few milliseconds, sharpening as the window grows, and never shows
+    audio from before the consumer arrived.
+*/
+class SpectrumAnalyser  : private juce::Thread
+{
+public:
+    //==============================================================================
+    /** FFT-related constants. The analysis is for visualization only. */
+    static constexpr int minFFTOrder     = 9;   // 2^9  = 512
+    static constexpr int maxFFTOrder     = 15;  // 2^15 = 32768
+    static constexpr int defaultFFTOrder = 10;  // 2^10 = 1024
+
+    static constexpr size_t maxFFTSize = 1 << maxFFTOrder;
+
+    /** Overlap settings, as used by setOverlap(): the hop is fftSize >> overlapIndex. */
+    static constexpr int maxOverlapIndex     = 3;   // 87.5%
+    static constexpr int defaultOverlapIndex = 2;   // 75%
+
+    //==============================================================================
+    SpectrumAnalyser();
+    ~SpectrumAnalyser() override;
+
+    /** Clears the ring and starts the analysis thread. Call from prepareToPlay(). */
+    void start (double sampleRate);
+
+    /** Stops the analysis thread. Call from releaseResources(). */
+    void stop();
+
+    /**
+        Audio thread: copies samples into the ring. Wait-free, never allocates.
+        Double-precision samples are narrowed to float on the way in. Only
+        call this while hasConsumers() is true.
+    */
+    template <typename SampleType>
+    void pushSamples (const SampleType* samples, int numSamples) noexcept;
+
+    //==============================================================================
+    /**
+        Message thread: registers interest in the analysis, waking it up if
+        it was idle. The first call ever allocates the ring and buffers.
+    */
+    void addConsumer();
+
+    /** Message thread: undoes one addConsumer(). The analysis idles once the last consumer has gone. */
+    void removeConsumer() noexcept;
+
+    /** Audio thread: whether anyone wants the analysis, i.e. whether to call pushSamples(). */
+    bool hasConsumers() const noexcept      { return numConsumers.load (std::memory_order_acquire) > 0; }
+
+    //==============================================================================
+    /** Any thread: selects an FFT size of 2^order, clamped to minFFTOrder..maxFFTOrder. */
+    void setFFTOrder (int order) noexcept;
+
+    /** Any thread: 0 = no overlap, 1 = 50%, 2 = 75%, 3 = 87.5%. */
+    void setOverlap (int overlapIndex) noexcept;
+
+    //==============================================================================
+    /** Decibel magnitudes of one analysed frame, one per FFT bin. */
+    struct ScopeFrame
+    {
+        std::array<float, maxFFTSize / 2> decibels;
+        int    numBins    = 0;      // fftSize / 2 of the frame's FFT
+        double sampleRate = 0.0;    // of the analysed signal, so bin i is at i * sampleRate / (2 * numBins)
+    };
+
+    /**
+        Message thread: picks up the newest complete frame, if one arrived.
+        Returns true if getLatestFrame() changed. Only one consumer may call this.
+    */
+    bool fetchLatestFrame() noexcept                        { return scopeFrames.acquireLatest(); }
+
+    /** Message thread: the frame picked up by the last fetchLatestFrame(). */
+    const ScopeFrame& getLatestFrame() const noexcept       { return scopeFrames.getReadBuffer(); }
+
+    /** Message thread: increasing number of the current frame, for skipping redundant repaints. */
+    juce::uint64 getLatestFrameNumber() const noexcept      { return scopeFrames.getReadFrameNumber(); }
+
+private:
+    //==============================================================================
+    void run() override;
+    void discardQueuedSamples() noexcept;
+    void readIntoHistory (int numSamples) noexcept;
+    void analyseFrame() noexcept;
+
+    // The FFT order of the next frame: fftOrder, or smaller while warming up
+    int getFrameOrder() const noexcept;
+    int getHopSize() const noexcept         { return (1 << getFrameOrder()) >> overlapIndex; }
+
+    static constexpr int numFFTOrders = maxFFTOrder - minFFTOrder + 1;
+
+    // Room for a couple of the largest frames so short stalls don't lose samples
+    static constexpr int ringSize = (int) maxFFTSize * 2;
+
+    juce::AbstractFifo   ringFifo { ringSize };
+    std::vector<float>   ringBuffer;
+
+    std::atomic<int> numConsumers { 0 };
+
+    // Settings requested from other threads, picked up by the analysis thread
+    std::atomic<int> requestedOrder   { defaultFFTOrder };
+    std::atomic<int> requestedOverlap { defaultOverlapIndex };
+
+    // Analysis thread state
+    double sampleRate         = 44100.0;
+    int fftOrder              = defaultFFTOrder;
+    int overlapIndex          = defaultOverlapIndex;
+    int samplesUntilNextFrame = 1 << minFFTOrder;
+
+    std::vector<float> history;             // circular, maxFFTSize long
+    int historyWritePos = 0;
+    int freshSamples    = 0;                // received since the last consumer arrived, up to maxFFTSize
+
+    std::vector<float> fftData;             // Real + Imag, 2 * maxFFTSize
+
+    // One shared FFT plan and Hann table per order, indexed by order - minFFTOrder
+    std::array<std::shared_ptr<const juce::dsp::FFT>, numFFTOrders>     ffts;
+    std::array<std::shared_ptr<const std::vector<float>>, numFFTOrders> windowTables;
+
+    // Finished decibel frames, published to the editor
+    TripleBuffer<ScopeFrame> scopeFrames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyser)
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Lock-free triple buffer for handing whole frames from one producer thread
+    to one consumer thread.
+
+    The producer fills getWriteBuffer() and calls publish(); the consumer calls
+    acquireLatest() and then reads getReadBuffer(). Neither side ever blocks or
+    waits for the other: the three slots are swapped through a single atomic
+    index, so the consumer only ever sees complete frames, always the newest
+    one, and the producer can publish as often as it likes. Frames the consumer
+    never picked up are simply overwritten.
+
+    Each published frame is numbered, so a consumer can tell whether the frame
+    it holds is one it has already used.
+*/
+template <typename FrameType>
+class TripleBuffer
+{
+public:
+    //==============================================================================
+    TripleBuffer() = default;
+
+    //==============================================================================
+    /** Producer: the slot to fill next. Only valid until the next publish(). */
+    FrameType& getWriteBuffer() noexcept            { return slots[writeIndex].frame; }
+
+    /** Producer: makes the write buffer the newest frame and takes back a free slot. */
+    void publish() noexcept
+    {
+        slots[writeIndex].frameNumber = ++publishedFrames;
+
+        const auto previous = middle.exchange ((juce::uint8) (writeIndex | newFrameFlag), std::memory_order_acq_rel);
+        writeIndex = (juce::uint8) (previous & indexMask);
+    }
+
+    //==============================================================================
+    /** Consumer: swaps in the newest published frame, if any. Returns true if it got a new one. */
+    bool acquireLatest() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & newFrameFlag) == 0)
+            return false;
+
+        const auto previous = middle.exchange (readIndex, std::memory_order_acq_rel);
+        readIndex = (juce::uint8) (previous & indexMask);
+        return true;
+    }
+
+    /** Consumer: the frame picked up by the last successful acquireLatest(). */
+    const FrameType& getReadBuffer() const noexcept     { return slots[readIndex].frame; }
+
+    /** Consumer: number of the frame in getReadBuffer() (0 until the first frame arrives). */
+    juce::uint64 getReadFrameNumber() const noexcept    { return slots[readIndex].frameNumber; }
+
+private:
+    //==============================================================================
+    struct Slot
+    {
+        FrameType    frame {};
+        juce::uint64 frameNumber = 0;
+    };
+
+    static constexpr juce::uint8 indexMask    = 0x03;
+    static constexpr juce::uint8 newFrameFlag = 0x04;
+
+    std::array<Slot, 3> slots;
+
+    juce::uint8              writeIndex = 0;    // owned by the producer
+    juce::uint8              readIndex  = 1;    // owned by the consumer
+    std::atomic<juce::uint8> middle     { 2 };  // the slot in between, plus the new-frame flag
+
+    juce::uint64 publishedFrames = 0;           // owned by the producer
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
@@ -0,0 +1,90 @@
+#include "WaterfallDisplay.h"
+
+//==============================================================================
+WaterfallDisplay::WaterfallDisplay()
+    : colourTable (SharedResources::get<ColourTable> (buildColourTable))
+{
+}
+
+std::unique_ptr<WaterfallDisplay::ColourTable> WaterfallDisplay::buildColourTable()
+{
+    auto table = std::make_unique<ColourTable>();
+
+    // Black -> blue -> magenta -> orange -> yellow -> white, evenly spaced
+    const juce::Colour stops[] = { juce::Colour (0, 0, 0),       juce::Colour (20, 10, 120),
+                                   juce::Colour (150, 20, 140),  juce::Colour (240, 100, 30),
+                                   juce::Colour (250, 220, 50),  juce::Colour (255, 255, 255) };
+
+    constexpr int numSegments = (int) std::size (stops) - 1;
+
+    for (int i = 0; i < colourTableSize; ++i)
+    {
+        const auto position = (float) i / (float) (colourTableSize - 1) * (float) numSegments;
+        const auto segment  = juce::jmin ((int) position, numSegments - 1);
+        const auto colour   = stops[segment].interpolatedWith (stops[segment + 1], position - (float) segment);
+
+        (*table)[(size_t) i] = juce::PixelARGB (255, colour.getRed(), colour.getGreen(), colour.getBlue());
+    }
+
+    return table;
+}
+
+//==============================================================================
+void WaterfallDisplay::setSize (int width, int height)
+{
+    width  = juce::jmax (0, width);
+    height = juce::jmax (0, height);
+
+    if (image.isValid() && image.getWidth() == width && image.getHeight() == height)
+        return;
+
+    image = (width > 0 && height > 0) ? juce::Image (juce::Image::ARGB, width, height, true)
+                                      : juce::Image();
+    writeColumn = 0;
+}
+
+void WaterfallDisplay::pushFrame (const SpectrumAnalyser::ScopeFrame& frame)
+{
+    if (! image.isValid() || frame.numBins < 2)
+        return;
+
+    const auto numRows = image.getHeight();
+    frequencyAxis.update (numRows, frame.numBins, frame.sampleRate);
+
+    juce::Image::BitmapData pixels (image, writeColumn, 0, 1, numRows, juce::Image::BitmapData::writeOnly);
+
+    for (int row = 0; row < numRows; ++row)
+    {
+        // Rows covering several bins show the loudest one
+        float minLevel, level;
+        frequencyAxis.getLevelRange (row, frame.decibels.data(), minLevel, level);
+
+        const auto index = (int) ((level - minDecibels) * ((float) (colourTableSize - 1) / (maxDecibels - minDecibels)));
+
+        // Row 0 is the lowest band, drawn at the bottom of the image
+        *reinterpret_cast<juce::PixelARGB*> (pixels.getPixelPointer (0, numRows - 1 - row))
+            = (*colourTable)[(size_t) juce::jlimit (0, colourTableSize - 1, index)];
+    }
+
+    writeColumn = (writeColumn + 1) % image.getWidth();
+}
+
+//==============================================================================
+void WaterfallDisplay::draw (juce::Graphics& g, juce::Rectangle<int> area) const
+{
+    if (! image.isValid())
+        return;
+
+    // The oldest column is the one about to be overwritten: draw from there to
+    // the end of the image, then wrap round to the start.
+    const auto width  = image.getWidth();
+    const auto height = image.getHeight();
+    const auto olderWidth = width - writeColumn;
+
+    g.drawImage (image, area.getX(), area.getY(), olderWidth, area.getHeight(),
+                 writeColumn, 0, olderWidth, height);
+
+    if (writeColumn > 0)
+        g.drawImage (image, area.getX() + olderWidth, area.getY(), writeColumn, area.getHeight(),
+                     0, 0, writeColumn, height);
+}
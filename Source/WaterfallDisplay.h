@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyser.h"
+#include "LogFrequencyAxis.h"
+
+//==============================================================================
+/**
+    Scrolling waterfall spectrogram: time runs right-to-left, frequency
+    bottom-to-top on a log scale, and colour shows the level.
+
+    The history lives in a juce::Image used as a ring of pixel columns. Each
+    analyser frame the editor receives is written into the next column through
+    a precomputed 256-entry colour table (one for the whole process, from
+    SharedResources), so adding a frame touches one column only. Scrolling
+    is done by drawing the ring in two pieces split at the write position, so
+    paint cost is two image blits however much history is on screen.
+
+    Message thread only.
+*/
+class WaterfallDisplay
+{
+public:
+    //==============================================================================
+    WaterfallDisplay();
+
+    /** Resizes the history to one column per pixel. Clears it if the size changed. */
+    void setSize (int width, int height);
+
+    /** Writes one frame into the next column. Each frame scrolls the view by one pixel. */
+    void pushFrame (const SpectrumAnalyser::ScopeFrame& frame);
+
+    /** Draws the history into area, oldest column on the left. */
+    void draw (juce::Graphics& g, juce::Rectangle<int> area) const;
+
+    /** Level range mapped onto the colour table. */
+    static constexpr float minDecibels = -100.0f;
+    static constexpr float maxDecibels = 0.0f;
+
+private:
+    //==============================================================================
+    static constexpr int colourTableSize = 256;
+    using ColourTable = std::array<juce::PixelARGB, colourTableSize>;
+
+    static std::unique_ptr<ColourTable> buildColourTable();
+
+    std::shared_ptr<const ColourTable> colourTable;
+
+    juce::Image image;
+    int writeColumn = 0;        // next column to write; also the oldest one on screen
+
+    // Rows of the image, bottom row first
+    LogFrequencyAxis frequencyAxis;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaterfallDisplay)
+};
@@ -0,0 +1,300 @@
+/*
+    Headless offline renderer: applies a saved SpectralEQ state to a batch of
+    audio files without a host.
+
+    Build this as a JUCE console application (juce_audio_formats,
+    juce_audio_processors, juce_dsp) that also compiles every .cpp file in
+    Source/ and defines JucePlugin_Name, in Release mode.
+
+    The state file is whatever the plugin's getStateInformation() produced
+    (e.g. saved from a host's preset menu), binary or, from older versions,
+    XML. Every WAV/AIFF file given, or found
+    under a given folder, is streamed through processBlock in large blocks and
+    written to the output folder with the same name, format and bit depth.
+
+    Files are spread over a pool of workers, each with its own processor, so
+    nothing is shared between threads. The processors render in non-realtime
+    mode, which keeps silent blocks going through the filters; the output then
+    doesn't depend on the block size (the cascade runs sample by sample with
+    continuous state, the linear-phase path in fixed partitions), so the result
+    is bit-identical to a host's offline export of the file with the same
+    state and sample rate.
+    The reported latency is trimmed from the start, as a host's delay
+    compensation would.
+
+    Usage: BatchRenderer --state <file> --output <folder> [--threads <n>]
+                         [--block-size <n>] <files or folders>...
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+namespace
+{
+    constexpr int defaultBlockSize = 8192;
+
+    /** Per-worker totals, summed once all workers have finished. */
+    struct RenderStats
+    {
+        int          numFiles     = 0;
+        double       audioSeconds = 0.0;
+        juce::StringArray errors;
+    };
+
+    //==============================================================================
+    /**
+        Renders files until the shared queue is empty. Owns its processor and
+        buffers, so workers never touch each other's state.
+    */
+    class RenderWorker  : public juce::ThreadPoolJob
+    {
+    public:
+        RenderWorker (const juce::Array<juce::File>& filesToRender, std::atomic<int>& nextFileIndex,
+                      const juce::MemoryBlock& stateToLoad, const juce::File& outputFolder, int blockSizeToUse)
+            : juce::ThreadPoolJob ("BatchRenderer worker"),
+              files (filesToRender), nextFile (nextFileIndex),
+              state (stateToLoad), outputDir (outputFolder), blockSize (blockSizeToUse)
+        {
+            formatManager.registerBasicFormats();
+            processor.setNonRealtime (true);
+            processor.setAnalyserEnabled (false);
+            processor.setStateInformation (state.getData(), (int) state.getSize());
+        }
+
+        JobStatus runJob() override
+        {
+            for (auto index = nextFile++; index < files.size() && ! shouldExit(); index = nextFile++)
+            {
+                const auto file = files[index];
+                const auto error = renderFile (file);
+
+                if (error.isNotEmpty())
+                    stats.errors.add (file.getFullPathName() + ": " + error);
+            }
+
+            return jobHasFinished;
+        }
+
+        const RenderStats& getStats() const noexcept    { return stats; }
+
+    private:
+        //==============================================================================
+        juce::String renderFile (const juce::File& input)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (input));
+
+            if (reader == nullptr)
+                return "can't read this file";
+
+            // The processor's bus takes the file's channel count, mono up to maxChannels
+            const auto numFileChannels = (int) reader->numChannels;
+
+            if (numFileChannels < 1 || numFileChannels > SpectralEQAudioProcessor::maxChannels)
+                return "only files with 1 to " + juce::String (SpectralEQAudioProcessor::maxChannels) + " channels are supported";
+
+            auto* format = formatManager.findFormatForFileExtension (input.getFileExtension());
+            const auto output = outputDir.getChildFile (input.getFileName());
+
+            if (format == nullptr || output == input)
+                return "can't write the output file";
+
+            output.deleteFile();
+            auto stream = std::make_unique<juce::FileOutputStream> (output);
+
+            if (! stream->openedOk())
+                return "can't open " + output.getFullPathName();
+
+            std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), reader->sampleRate,
+                                                                                     (unsigned int) numFileChannels,
+                                                                                     (int) reader->bitsPerSample, {}, 0));
+            if (writer == nullptr)
+                return "the output format doesn't support this sample rate or bit depth";
+
+            stream.release();   // now owned by the writer
+
+            // A fresh prepareToPlay per file, as a host does before playback: clears all filter state
+            processor.setPlayConfigDetails (numFileChannels, numFileChannels, reader->sampleRate, blockSize);
+            processor.prepareToPlay (reader->sampleRate, blockSize);
+
+            // Like a host's delay compensation, drop the first latency samples so the output lines up with the input
+            const auto latency      = (juce::int64) processor.getLatencySamples();
+            const auto tailSamples  = (juce::int64) std::ceil (processor.getTailLengthSeconds() * reader->sampleRate);
+            const auto totalSamples = reader->lengthInSamples + tailSamples + latency;
+
+            buffer.setSize (numFileChannels, blockSize, false, false, true);
+
+            for (juce::int64 pos = 0; pos < totalSamples; pos += blockSize)
+            {
+                const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, totalSamples - pos);
+
+                // Past the end of the file the reader fills with silence, which renders the tail
+                reader->read (&buffer, 0, numSamples, pos, true, true);
+
+                // The last block is usually short; process it through a view rather than resizing
+                juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), numFileChannels, numSamples);
+                midi.clear();
+                processor.processBlock (block, midi);
+
+                const auto skip = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, latency - pos);
+
+                if (! writer->writeFromAudioSampleBuffer (block, skip, numSamples - skip))
+                    return "write failed";
+            }
+
+            processor.releaseResources();
+
+            ++stats.numFiles;
+            stats.audioSeconds += (double) reader->lengthInSamples / reader->sampleRate;
+            return {};
+        }
+
+        //==============================================================================
+        const juce::Array<juce::File>& files;
+        std::atomic<int>& nextFile;
+        const juce::MemoryBlock& state;
+        const juce::File outputDir;
+        const int blockSize;
+
+        juce::AudioFormatManager formatManager;
+        SpectralEQAudioProcessor processor;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer         midi;
+
+        RenderStats stats;
+
+        JUCE_DECLARE_NON_COPYABLE (RenderWorker)
+    };
+
+    //==============================================================================
+    bool isAudioFile (const juce::File& file)
+    {
+        return file.hasFileExtension ("wav;aif;aiff");
+    }
+
+    /** Positional arguments: input files, and the audio files found under input folders. */
+    juce::Array<juce::File> findInputFiles (const juce::ArgumentList& args)
+    {
+        juce::Array<juce::File> files;
+
+        for (int i = 0; i < args.arguments.size(); ++i)
+        {
+            const auto& arg = args.arguments.getReference (i);
+
+            if (arg.isOption())
+            {
+                // Skip the value of a "--option value" pair
+                if (! arg.text.containsChar ('='))
+                    ++i;
+
+                continue;
+            }
+
+            const auto file = arg.resolveAsFile();
+
+            if (file.isDirectory())
+            {
+                for (const auto& child : file.findChildFiles (juce::File::findFiles, true, "*.wav;*.aif;*.aiff"))
+                    files.add (child);
+            }
+            else if (isAudioFile (file))
+            {
+                files.add (file);
+            }
+            else
+            {
+                std::fprintf (stderr, "Skipping %s: not a WAV or AIFF file\n", arg.text.toRawUTF8());
+            }
+        }
+
+        return files;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args (argc, argv);
+
+    if (! args.containsOption ("--state") || ! args.containsOption ("--output"))
+    {
+        std::printf ("Usage: BatchRenderer --state <file> --output <folder> [--threads <n>] [--block-size <n>] <files or folders>...\n");
+        return 1;
+    }
+
+    juce::MemoryBlock state;
+
+    if (! args.getFileForOption ("--state").loadFileAsData (state))
+    {
+        std::fprintf (stderr, "Can't read the state file\n");
+        return 1;
+    }
+
+    const auto outputDir = args.getFileForOption ("--output");
+
+    if (! outputDir.createDirectory())
+    {
+        std::fprintf (stderr, "Can't create the output folder\n");
+        return 1;
+    }
+
+    const auto files = findInputFiles (args);
+
+    if (files.size() == 0)
+    {
+        std::fprintf (stderr, "No input files\n");
+        return 1;
+    }
+
+    const auto numThreads = juce::jlimit (1, files.size(), args.containsOption ("--threads")
+                                                             ? args.getValueForOption ("--threads").getIntValue()
+                                                             : juce::SystemStats::getNumCpus());
+    const auto blockSize  = args.containsOption ("--block-size")
+                              ? juce::jlimit (32, 65536, args.getValueForOption ("--block-size").getIntValue())
+                              : defaultBlockSize;
+
+    std::printf ("Rendering %d files on %d threads, %d-sample blocks\n", files.size(), numThreads, blockSize);
+
+    // One long-running job per pool thread; each pulls files until none are left
+    std::atomic<int> nextFile { 0 };
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    {
+        juce::ThreadPool pool (numThreads);
+
+        for (int i = 0; i < numThreads; ++i)
+        {
+            workers.push_back (std::make_unique<RenderWorker> (files, nextFile, state, outputDir, blockSize));
+            pool.addJob (workers.back().get(), false);
+        }
+
+        for (auto& worker : workers)
+            pool.waitForJobToFinish (worker.get(), -1);
+    }
+
+    const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+    RenderStats total;
+
+    for (auto& worker : workers)
+    {
+        const auto& stats = worker->getStats();
+        total.numFiles     += stats.numFiles;
+        total.audioSeconds += stats.audioSeconds;
+
+        for (const auto& error : stats.errors)
+            total.errors.add (error);
+    }
+
+    for (const auto& error : total.errors)
+        std::fprintf (stderr, "Failed: %s\n", error.toRawUTF8());
+
+    std::printf ("Rendered %d of %d files (%.1f s of audio) in %.2f s: %.2f files/s, %.1fx real time\n",
+                 total.numFiles, files.size(), total.audioSeconds, seconds,
+                 (double) total.numFiles / seconds, total.audioSeconds / seconds);
+
+    return total.errors.size() == 0 ? 0 : 1;
+}
@@ -0,0 +1,1125 @@
+/*
+    Headless throughput benchmarks for the SpectralEQ DSP.
+
+    Build this as a JUCE console application (juce_audio_processors, juce_dsp)
+    that also compiles every .cpp file in Source/ and defines JucePlugin_Name,
+    in Release mode.
+
+    Besides the BiquadCascade comparisons, it times the whole processBlock()
+    over a grid of sample rates, block sizes and band configurations, with
+    static and continuously automated parameters and with the analyser on and
+    off, and breaks the cost down into its parts: the analyser's per-frame FFT
+    work, coefficient design and the filter cascade. The bilinear and matched
+    peak designs are also compared with 4x oversampling, for cost and accuracy,
+    and the float and double processing paths are timed side by side. The
+    cascade is also timed on buses from mono up to 16 channels, and a silent
+    track is compared with a busy one. The table-driven coefficients for
+    audio-rate modulation are checked against the exact design and timed,
+    on their own and in processBlock(). Finally, saving and restoring the
+    plugin state is timed per instance, binary against XML, and so is creating
+    and preparing an instance, the first one against those that share its
+    resources. Before the state is timed, it is checked: a binary state must
+    restore every parameter exactly, a corrupted or truncated one must be
+    rejected, and an XML state from before the binary format must still load.
+    Any failure makes the exit code non-zero.
+
+    Times are per sample frame (all channels). With --json, every result is
+    also written to a machine-readable file for tracking regressions.
+
+    Usage: Benchmarks [--seconds <n>] [--json <file>]
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/BiquadCascade.h"
+#include "../../Source/PeakCoefficientTable.h"
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int    blockSize  = 512;
+
+    /** Long enough for several of the largest blocks per pass. */
+    constexpr int sourceLength = 65536;
+
+    const double sampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    const int    blockSizes[]  = { 1, 16, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+
+    /** The three default bands, slightly boosted so the filters aren't trivial. */
+    const double bandSettings[3][3] = { {  200.0, 0.7, 2.0 },
+                                        { 1000.0, 1.0, 0.5 },
+                                        { 5000.0, 2.0, 1.5 } };
+
+    template <typename SampleType>
+    void fillWithNoise (juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::Random random (42);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, (SampleType) (random.nextFloat() * 2.0f - 1.0f));
+    }
+
+    /**
+        Runs process over consecutive in-place blocks of a fresh copy of the
+        source until the time budget is spent, and returns ns per sample frame.
+        Refreshing the copy between passes isn't timed.
+    */
+    template <typename SampleType, typename ProcessFn>
+    double measureNanosPerSample (const juce::AudioBuffer<SampleType>& source, int samplesPerBlock,
+                                  double secondsToRun, ProcessFn&& process)
+    {
+        juce::AudioBuffer<SampleType> work (source.getNumChannels(), source.getNumSamples());
+
+        const auto samplesPerPass = source.getNumSamples() / samplesPerBlock * samplesPerBlock;
+        const auto budget = (juce::int64) (secondsToRun * (double) juce::Time::getHighResolutionTicksPerSecond());
+
+        juce::int64 samplesProcessed = 0, ticksSpent = 0;
+
+        while (ticksSpent < budget)
+        {
+            work.makeCopyOf (source, true);
+            juce::dsp::AudioBlock<SampleType> whole (work);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int pos = 0; pos < samplesPerPass; pos += samplesPerBlock)
+            {
+                auto block = whole.getSubBlock ((size_t) pos, (size_t) samplesPerBlock);
+                process (block);
+            }
+
+            ticksSpent += juce::Time::getHighResolutionTicks() - start;
+            samplesProcessed += samplesPerPass;
+        }
+
+        return juce::Time::highResolutionTicksToSeconds (ticksSpent) * 1.0e9 / (double) samplesProcessed;
+    }
+
+    //==============================================================================
+    /** Appends one measurement to a section of the --json results. */
+    void addResult (juce::DynamicObject& results, const juce::Identifier& section, juce::DynamicObject* entry)
+    {
+        if (! results.hasProperty (section))
+            results.setProperty (section, juce::Array<juce::var>());
+
+        results.getProperty (section).getArray()->add (juce::var (entry));
+    }
+
+    //==============================================================================
+    /** Compares the old ProcessorChain<PeakFilter x3> with both BiquadCascade kernels. */
+    void runCascadeBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        using Filter     = juce::dsp::IIR::Filter<float>;
+        using Coeffs     = juce::dsp::IIR::Coefficients<float>;
+        using PeakFilter = juce::dsp::ProcessorDuplicator<Filter, Coeffs>;
+        using Cascade    = BiquadCascade<float, 3>;
+
+        juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) blockSize, 2 };
+
+        juce::dsp::ProcessorChain<PeakFilter, PeakFilter, PeakFilter> chain;
+        chain.prepare (spec);
+
+        Cascade scalar, simd;
+        scalar.prepare (spec);
+        simd.prepare (spec);
+        scalar.setKernel (Cascade::Kernel::scalar);
+        simd.setKernel (Cascade::Kernel::simd);
+
+        auto designBand = [] (size_t b)
+        {
+            return BiquadCoefficients<float>::makePeak (sampleRate, bandSettings[b][0], bandSettings[b][1], bandSettings[b][2]);
+        };
+
+        for (size_t b = 0; b < 3; ++b)
+        {
+            scalar.setCoefficients (b, designBand (b));
+            simd.setCoefficients (b, designBand (b));
+            scalar.setBandEnabled (b, true);
+            simd.setBandEnabled (b, true);
+        }
+
+        designBand (0).copyTo (*chain.get<0>().state);
+        designBand (1).copyTo (*chain.get<1>().state);
+        designBand (2).copyTo (*chain.get<2>().state);
+
+        juce::AudioBuffer<float> source (2, sourceLength);
+        fillWithNoise (source);
+
+        // Accuracy: run the same signal through the chain and the SIMD cascade
+        {
+            juce::AudioBuffer<float> reference (source), candidate (source);
+            juce::dsp::AudioBlock<float> refBlock (reference), candBlock (candidate);
+
+            chain.process (juce::dsp::ProcessContextReplacing<float> (refBlock));
+            simd.process (juce::dsp::ProcessContextReplacing<float> (candBlock));
+
+            float maxError = 0.0f;
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < source.getNumSamples(); ++i)
+                    maxError = juce::jmax (maxError, std::abs (reference.getSample (ch, i) - candidate.getSample (ch, i)));
+
+            std::printf ("cascade: max abs difference vs ProcessorChain = %g\n", (double) maxError);
+            results.setProperty ("cascadeMaxAbsDifference", maxError);
+
+            chain.reset();
+            simd.reset();
+        }
+
+        auto run = [&] (const char* name, auto&& fn)
+        {
+            auto nanosPerSample = measureNanosPerSample (source, blockSize, secondsPerCase, fn);
+            std::printf ("cascade: %-24s %8.1f Msamples/s per channel\n", name, 1000.0 / nanosPerSample);
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty ("implementation", name);
+            entry->setProperty ("nsPerSample", nanosPerSample);
+            addResult (results, "cascade", entry);
+        };
+
+        run ("ProcessorChain x3", [&] (juce::dsp::AudioBlock<float>& block) { chain.process (juce::dsp::ProcessContextReplacing<float> (block)); });
+        run ("BiquadCascade scalar", [&] (juce::dsp::AudioBlock<float>& block) { scalar.process (juce::dsp::ProcessContextReplacing<float> (block)); });
+        run ("BiquadCascade SIMD", [&] (juce::dsp::AudioBlock<float>& block) { simd.process (juce::dsp::ProcessContextReplacing<float> (block)); });
+    }
+
+    /** Filtering on its own: SIMD cascade cost as the number of enabled bands and the block size change. */
+    void runFilterBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        using Cascade = BiquadCascade<float, 24>;
+
+        juce::AudioBuffer<float> source (2, sourceLength);
+        fillWithNoise (source);
+
+        for (size_t numEnabled : { 0, 1, 3, 8, 12, 16, 24 })
+        {
+            for (auto samplesPerBlock : { 1, 64, 512, 8192 })
+            {
+                Cascade cascade;
+                cascade.prepare ({ sampleRate, (juce::uint32) samplesPerBlock, 2 });
+
+                for (size_t b = 0; b < numEnabled; ++b)
+                {
+                    const auto freq = 30.0 * std::pow (500.0, (double) b / 24.0);
+                    cascade.setCoefficients (b, BiquadCoefficients<float>::makePeak (sampleRate, freq, 1.0, 1.5));
+                    cascade.setBandEnabled (b, true);
+                }
+
+                auto nanosPerSample = measureNanosPerSample (source, samplesPerBlock, secondsPerCase, [&] (juce::dsp::AudioBlock<float>& block)
+                {
+                    cascade.process (juce::dsp::ProcessContextReplacing<float> (block));
+                });
+
+                std::printf ("filter:  %2d of 24 bands, block %4d %10.2f ns/sample\n", (int) numEnabled, samplesPerBlock, nanosPerSample);
+
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty ("enabledBands", (int) numEnabled);
+                entry->setProperty ("blockSize", samplesPerBlock);
+                entry->setProperty ("nsPerSample", nanosPerSample);
+                addResult (results, "filter", entry);
+            }
+        }
+    }
+
+    /** Coefficient design on its own: one peak per call, with varying settings, for both designs. */
+    void runCoefficientBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        struct Settings { double freq, q, gain; };
+        std::vector<Settings> settings (4096);
+
+        juce::Random random (7);
+
+        for (auto& s : settings)
+            s = { 20.0 * std::pow (1000.0, (double) random.nextFloat()),
+                  0.1 + 9.9 * (double) random.nextFloat(),
+                  juce::Decibels::decibelsToGain (-24.0 + 48.0 * (double) random.nextFloat()) };
+
+        using DesignFunction = BiquadCoefficients<float> (*) (double, double, double, double) noexcept;
+
+        auto run = [&] (const char* name, const char* property, DesignFunction design)
+        {
+            const auto budget = (juce::int64) (secondsPerCase * (double) juce::Time::getHighResolutionTicksPerSecond());
+            const auto start  = juce::Time::getHighResolutionTicks();
+
+            juce::int64 numDesigns = 0;
+            float checksum = 0.0f;
+
+            while (juce::Time::getHighResolutionTicks() - start < budget)
+            {
+                for (const auto& s : settings)
+                    checksum += design (sampleRate, s.freq, s.q, s.gain).b0;
+
+                numDesigns += (juce::int64) settings.size();
+            }
+
+            const auto nanosPerDesign = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start)
+                                          * 1.0e9 / (double) numDesigns;
+
+            // The checksum only keeps the designs from being optimised away
+            std::printf ("coeffs:  %-20s %18.2f ns/band (checksum %g)\n", name, nanosPerDesign, (double) checksum);
+            results.setProperty (property, nanosPerDesign);
+        };
+
+        run ("makePeak",        "coefficientsNsPerBand",        &BiquadCoefficients<float>::makePeak);
+        run ("makeMatchedPeak", "matchedCoefficientsNsPerBand", &BiquadCoefficients<float>::makeMatchedPeak);
+    }
+
+    //==============================================================================
+    /** |H| in dB of one section at a normalised angular frequency. */
+    double getMagnitudeDecibels (const BiquadCoefficients<double>& c, double omega)
+    {
+        const auto z1 = std::polar (1.0, -omega);
+        const auto z2 = std::polar (1.0, -2.0 * omega);
+
+        return juce::Decibels::gainToDecibels (std::abs ((c.b0 + c.b1 * z1 + c.b2 * z2) / (1.0 + c.a1 * z1 + c.a2 * z2)), -200.0);
+    }
+
+    /** |H| in dB of the analog peak that makePeak() and makeMatchedPeak() approximate. */
+    double getAnalogPeakDecibels (double frequency, double centre, double Q, double gainFactor)
+    {
+        const auto A      = std::sqrt (gainFactor);
+        const auto w      = frequency / centre;
+        const auto detune = juce::square (1.0 - w * w);
+
+        return 10.0 * std::log10 ((detune + juce::square (w * A / Q)) / (detune + juce::square (w / (A * Q))));
+    }
+
+    /**
+        Three ways of getting a peak right near Nyquist: plain bilinear design,
+        the matched design, and bilinear design at 4x with oversampling.
+
+        The response error is the largest deviation from the analog peak
+        between 20 Hz and 95% of Nyquist, over a grid of upper-range settings.
+        The 4x figure is for the filter alone; the half-band filters add their
+        own small passband ripple on top. The cost is three bands per sample,
+        including the up- and downsampling for 4x.
+    */
+    void runPeakDesignBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        using Coefficients = BiquadCoefficients<double>;
+
+        const char* names[] = { "bilinear", "matched", "bilinear 4x" };
+        const double rateRatios[] = { 1.0, 1.0, 4.0 };
+
+        for (auto rate : { 44100.0, 48000.0 })
+        {
+            double maxError[3] {}, sumError[3] {};
+            int numSettings = 0;
+
+            for (auto freq : { 1000.0, 4000.0, 8000.0, 12000.0, 16000.0, 20000.0 })
+            {
+                for (auto q : { 0.3, 0.7, 1.0, 2.0, 5.0 })
+                {
+                    for (auto gainDb : { -12.0, -6.0, 6.0, 12.0 })
+                    {
+                        const auto gain = juce::Decibels::decibelsToGain (gainDb);
+
+                        const Coefficients designs[] = { Coefficients::makePeak (rate, freq, q, gain),
+                                                         Coefficients::makeMatchedPeak (rate, freq, q, gain),
+                                                         Coefficients::makePeak (rate * 4.0, freq, q, gain) };
+                        double error[3] {};
+
+                        for (int i = 0; i <= 500; ++i)
+                        {
+                            const auto f      = 20.0 * std::pow (rate * 0.475 / 20.0, (double) i / 500.0);
+                            const auto omega  = juce::MathConstants<double>::twoPi * f / rate;
+                            const auto target = getAnalogPeakDecibels (f, freq, q, gain);
+
+                            for (int d = 0; d < 3; ++d)
+                                error[d] = juce::jmax (error[d], std::abs (getMagnitudeDecibels (designs[d], omega / rateRatios[d]) - target));
+                        }
+
+                        for (int d = 0; d < 3; ++d)
+                        {
+                            maxError[d] = juce::jmax (maxError[d], error[d]);
+                            sumError[d] += error[d];
+                        }
+
+                        ++numSettings;
+                    }
+                }
+            }
+
+            for (int d = 0; d < 3; ++d)
+            {
+                std::printf ("design:  %6.0f Hz, %-12s max error %6.2f dB, mean %6.2f dB\n",
+                             rate, names[d], maxError[d], sumError[d] / numSettings);
+
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty ("sampleRate", rate);
+                entry->setProperty ("design", names[d]);
+                entry->setProperty ("maxErrorDb", maxError[d]);
+                entry->setProperty ("meanErrorDb", sumError[d] / numSettings);
+                addResult (results, "peakDesignError", entry);
+            }
+        }
+
+        // Cost: the default three bands at the base rate, or at 4x with the oversampler around them
+        using Cascade = BiquadCascade<float, 3>;
+
+        juce::AudioBuffer<float> source (2, sourceLength);
+        fillWithNoise (source);
+
+        Cascade direct, oversampled;
+        direct.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+        oversampled.prepare ({ sampleRate * 4.0, (juce::uint32) blockSize * 4, 2 });
+
+        juce::dsp::Oversampling<float> oversampler (2, 2, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, true);
+        oversampler.initProcessing ((size_t) blockSize);
+
+        for (size_t b = 0; b < 3; ++b)
+        {
+            direct.setCoefficients (b, BiquadCoefficients<float>::makeMatchedPeak (sampleRate, bandSettings[b][0], bandSettings[b][1], bandSettings[b][2]));
+            oversampled.setCoefficients (b, BiquadCoefficients<float>::makePeak (sampleRate * 4.0, bandSettings[b][0], bandSettings[b][1], bandSettings[b][2]));
+            direct.setBandEnabled (b, true);
+            oversampled.setBandEnabled (b, true);
+        }
+
+        auto run = [&] (const char* name, auto&& fn)
+        {
+            auto nanosPerSample = measureNanosPerSample (source, blockSize, secondsPerCase, fn);
+            std::printf ("design:  %-30s %10.2f ns/sample\n", name, nanosPerSample);
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty ("implementation", name);
+            entry->setProperty ("nsPerSample", nanosPerSample);
+            addResult (results, "peakDesignCost", entry);
+        };
+
+        // Bilinear and matched sections cost the same to run, so one figure covers both
+        run ("3 bands at the base rate", [&] (juce::dsp::AudioBlock<float>& block)
+        {
+            direct.process (juce::dsp::ProcessContextReplacing<float> (block));
+        });
+
+        run ("3 bands, 4x oversampled", [&] (juce::dsp::AudioBlock<float>& block)
+        {
+            auto upsampled = oversampler.processSamplesUp (block);
+            oversampled.process (juce::dsp::ProcessContextReplacing<float> (upsampled));
+            oversampler.processSamplesDown (block);
+        });
+    }
+
+    /**
+        The analyser's per-frame work on its own, done the same way as
+        SpectrumAnalyser::analyseFrame(): window, real FFT, magnitudes to dB.
+        The per-sample figure assumes the default overlap.
+    */
+    void runFFTBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        juce::Random random (3);
+
+        for (int order = SpectrumAnalyser::minFFTOrder; order <= SpectrumAnalyser::maxFFTOrder; ++order)
+        {
+            const auto size = 1 << order;
+
+            juce::dsp::FFT fft (order);
+            std::vector<float> window ((size_t) size), input ((size_t) size), data ((size_t) size * 2), decibels ((size_t) size / 2);
+
+            juce::dsp::WindowingFunction<float>::fillWindowingTables (window.data(), (size_t) size,
+                                                                      juce::dsp::WindowingFunction<float>::hann);
+
+            for (auto& x : input)
+                x = random.nextFloat() * 2.0f - 1.0f;
+
+            const auto budget = (juce::int64) (secondsPerCase * (double) juce::Time::getHighResolutionTicksPerSecond());
+            const auto start  = juce::Time::getHighResolutionTicks();
+
+            juce::int64 numFrames = 0;
+
+            while (juce::Time::getHighResolutionTicks() - start < budget)
+            {
+                std::copy (input.begin(), input.end(), data.begin());
+                std::fill (data.begin() + size, data.end(), 0.0f);
+                juce::FloatVectorOperations::multiply (data.data(), window.data(), size);
+
+                fft.performRealOnlyForwardTransform (data.data());
+
+                const auto scale = 2.0f / (float) size;
+
+                for (int i = 0; i < size / 2; ++i)
+                    decibels[(size_t) i] = juce::Decibels::gainToDecibels (std::hypot (data[(size_t) i * 2], data[(size_t) i * 2 + 1]) * scale);
+
+                ++numFrames;
+            }
+
+            const auto nanosPerFrame = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start)
+                                         * 1.0e9 / (double) numFrames;
+            const auto hop = size >> SpectrumAnalyser::defaultOverlapIndex;
+
+            std::printf ("fft:     size %5d %14.0f ns/frame %10.2f ns/sample\n", size, nanosPerFrame, nanosPerFrame / hop);
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty ("fftSize", size);
+            entry->setProperty ("nsPerFrame", nanosPerFrame);
+            entry->setProperty ("nsPerSample", nanosPerFrame / hop);
+            addResult (results, "fft", entry);
+        }
+    }
+
+    //==============================================================================
+    /**
+        The whole processBlock(), as a host would call it: every sample rate and
+        block size, with the default three bands or all 24, with and without
+        automation, and with the analyser on and off.
+
+        Automation moves the frequency and gain of every enabled band before
+        each block, so every band is always gliding. The bands are redesigned
+        once per control interval rather than once per block, so the automated
+        cost per sample should stay flat from 1-sample to 8192-sample blocks.
+    */
+    void runProcessBlockBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        juce::AudioBuffer<float> source (2, sourceLength);
+        fillWithNoise (source);
+
+        juce::MidiBuffer midi;
+
+        for (auto rate : sampleRates)
+        {
+            for (auto allBands : { false, true })
+            {
+                SpectralEQAudioProcessor processor;
+
+                // All bands on with a small boost; the default layout otherwise
+                if (allBands)
+                {
+                    for (size_t b = 0; b < SpectralEQAudioProcessor::maxBands; ++b)
+                    {
+                        auto* gain = processor.apvts.getParameter (SpectralEQAudioProcessor::getBandParameterID (b, "Gain"));
+                        gain->setValueNotifyingHost (gain->convertTo0to1 (2.0f));
+                        processor.apvts.getParameter (SpectralEQAudioProcessor::getBandParameterID (b, "On"))->setValueNotifyingHost (1.0f);
+                    }
+                }
+
+                const auto numBands = allBands ? (int) SpectralEQAudioProcessor::maxBands : 3;
+
+                std::vector<juce::RangedAudioParameter*> automated;
+
+                for (size_t b = 0; b < (size_t) numBands; ++b)
+                {
+                    automated.push_back (processor.apvts.getParameter (SpectralEQAudioProcessor::getBandParameterID (b, "Freq")));
+                    automated.push_back (processor.apvts.getParameter (SpectralEQAudioProcessor::getBandParameterID (b, "Gain")));
+                }
+
+                for (auto analyserOn : { false, true })
+                {
+                    processor.setAnalyserEnabled (analyserOn);
+
+                    if (analyserOn)
+                        processor.analyser.addConsumer();
+                    processor.setRateAndBufferSizeDetails (rate, blockSizes[std::size (blockSizes) - 1]);
+                    processor.prepareToPlay (rate, blockSizes[std::size (blockSizes) - 1]);
+
+                    for (auto samplesPerBlock : blockSizes)
+                    {
+                        for (auto automation : { false, true })
+                        {
+                            float sweep = 0.0f;
+
+                            auto nanosPerSample = measureNanosPerSample (source, samplesPerBlock, secondsPerCase, [&] (juce::dsp::AudioBlock<float>& block)
+                            {
+                                if (automation)
+                                {
+                                    sweep = std::fmod (sweep + 0.001f, 1.0f);
+
+                                    for (auto* param : automated)
+                                        param->setValueNotifyingHost (0.25f + 0.5f * sweep);
+                                }
+
+                                float* channels[] = { block.getChannelPointer (0), block.getChannelPointer (1) };
+                                juce::AudioBuffer<float> buffer (channels, 2, (int) block.getNumSamples());
+                                processor.processBlock (buffer, midi);
+                            });
+
+                            std::printf ("process: %6.0f Hz, block %4d, %2d bands, %-9s analyser %-3s %10.2f ns/sample\n",
+                                         rate, samplesPerBlock, numBands, automation ? "automated" : "static",
+                                         analyserOn ? "on" : "off", nanosPerSample);
+
+                            auto* entry = new juce::DynamicObject();
+                            entry->setProperty ("sampleRate", rate);
+                            entry->setProperty ("blockSize", samplesPerBlock);
+                            entry->setProperty ("enabledBands", numBands);
+                            entry->setProperty ("automated", automation);
+                            entry->setProperty ("analyser", analyserOn);
+                            entry->setProperty ("nsPerSample", nanosPerSample);
+                            addResult (results, "processBlock", entry);
+                        }
+                    }
+
+                    processor.releaseResources();
+                }
+            }
+        }
+    }
+
+    //==============================================================================
+    /**
+        Float vs double: the SIMD cascade on its own (half as many lanes per
+        register in double), then the whole processBlock() through each of
+        the two overloads a host can call.
+    */
+    template <typename SampleType>
+    void runPrecisionCase (const char* precision, double secondsPerCase, juce::DynamicObject& results)
+    {
+        juce::AudioBuffer<SampleType> source (2, sourceLength);
+        fillWithNoise (source);
+
+        for (size_t numEnabled : { 3, 24 })
+        {
+            BiquadCascade<SampleType, 24> cascade;
+            cascade.prepare ({ sampleRate, (juce::uint32) blockSize, 2 });
+
+            for (size_t b = 0; b < numEnabled; ++b)
+            {
+                const auto freq = 30.0 * std::pow (500.0, (double) b / 24.0);
+                cascade.setCoefficients (b, BiquadCoefficients<SampleType>::makePeak (sampleRate, freq, 1.0, 1.5));
+                cascade.setBandEnabled (b, true);
+            }
+
+            auto nanosPerSample = measureNanosPerSample (source, blockSize, secondsPerCase, [&] (juce::dsp::AudioBlock<SampleType>& block)
+            {
+                cascade.process (juce::dsp::ProcessContextReplacing<SampleType> (block));
+            });
+
+            std::printf ("precision: %-6s cascade, %2d bands %16.2f ns/sample\n", precision, (int) numEnabled, nanosPerSample);
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty ("precision", precision);
+            entry->setProperty ("stage", "cascade");
+            entry->setProperty ("enabledBands", (int) numEnabled);
+            entry->setProperty ("nsPerSample", nanosPerSample);
+            addResult (results, "precision", entry);
+        }
+
+        SpectralEQAudioProcessor processor;
+        processor.setAnalyserEnabled (false);
+        processor.setProcessingPrecision (std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                              : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        juce::MidiBuffer midi;
+
+        auto nanosPerSample = measureNanosPerSample (source, blockSize, secondsPerCase, [&] (juce::dsp::AudioBlock<SampleType>& block)
+        {
+            SampleType* channels[] = { block.getChannelPointer (0), block.getChannelPointer (1) };
+            juce::AudioBuffer<SampleType> buffer (channels, 2, (int) block.getNumSamples());
+            processor.processBlock (buffer, midi);
+        });
+
+        processor.releaseResources();
+
+        std::printf ("precision: %-6s processBlock, 3 bands %10.2f ns/sample\n", precision, nanosPerSample);
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty ("precision", precision);
+        entry->setProperty ("stage", "processBlock");
+        entry->setProperty ("enabledBands", 3);
+        entry->setProperty ("nsPerSample", nanosPerSample);
+        addResult (results, "precision", entry);
+    }
+
+    void runPrecisionBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        runPrecisionCase<float>  ("float",  secondsPerCase, results);
+        runPrecisionCase<double> ("double", secondsPerCase, results);
+    }
+
+    //==============================================================================
+    /**
+        The cascade across channel counts, mono up to a 16-channel bus. Channels
+        share SIMD registers a group at a time, so the cost per frame grows
+        with the number of groups rather than with the number of channels.
+    */
+    void runChannelBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        using Cascade = BiquadCascade<float, 24>;
+
+        for (auto numChannels : { 1, 2, 4, 6, 8, 12, 16 })
+        {
+            juce::AudioBuffer<float> source (numChannels, sourceLength);
+            fillWithNoise (source);
+
+            for (size_t numEnabled : { 3, 24 })
+            {
+                Cascade cascade;
+                cascade.prepare ({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+
+                for (size_t b = 0; b < numEnabled; ++b)
+                {
+                    const auto freq = 30.0 * std::pow (500.0, (double) b / 24.0);
+                    cascade.setCoefficients (b, BiquadCoefficients<float>::makePeak (sampleRate, freq, 1.0, 1.5));
+                    cascade.setBandEnabled (b, true);
+                }
+
+                auto nanosPerSample = measureNanosPerSample (source, blockSize, secondsPerCase, [&] (juce::dsp::AudioBlock<float>& block)
+                {
+                    cascade.process (juce::dsp::ProcessContextReplacing<float> (block));
+                });
+
+                std::printf ("channels: %2d channels, %2d bands %12.2f ns/frame %8.2f ns/channel\n",
+                             numChannels, (int) numEnabled, nanosPerSample, nanosPerSample / numChannels);
+
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty ("channels", numChannels);
+                entry->setProperty ("enabledBands", (int) numEnabled);
+                entry->setProperty ("nsPerSample", nanosPerSample);
+                addResult (results, "channels", entry);
+            }
+        }
+    }
+
+    //==============================================================================
+    /**
+        processBlock() on a silent track, against the same instance on noise:
+        once the filters have rung out, silent blocks skip the filters and the
+        analyser entirely.
+    */
+    void runSilenceBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        juce::AudioBuffer<float> noise (2, sourceLength), silence (2, sourceLength);
+        fillWithNoise (noise);
+        silence.clear();
+
+        juce::MidiBuffer midi;
+
+        for (auto silent : { false, true })
+        {
+            SpectralEQAudioProcessor processor;
+            processor.analyser.addConsumer();
+            processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processor.prepareToPlay (sampleRate, blockSize);
+
+            juce::int64 numBlocks = 0;
+
+            auto nanosPerSample = measureNanosPerSample (silent ? silence : noise, blockSize, secondsPerCase, [&] (juce::dsp::AudioBlock<float>& block)
+            {
+                float* channels[] = { block.getChannelPointer (0), block.getChannelPointer (1) };
+                juce::AudioBuffer<float> buffer (channels, 2, (int) block.getNumSamples());
+                processor.processBlock (buffer, midi);
+                ++numBlocks;
+            });
+
+            const auto idleBlocks = (juce::int64) processor.getNumIdleBlocks();
+            processor.releaseResources();
+
+            std::printf ("silence: %-7s input %10.2f ns/sample, %lld of %lld blocks idle\n",
+                         silent ? "silent" : "noise", nanosPerSample, (long long) idleBlocks, (long long) numBlocks);
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty ("input", silent ? "silent" : "noise");
+            entry->setProperty ("nsPerSample", nanosPerSample);
+            entry->setProperty ("idleBlocks", idleBlocks);
+            entry->setProperty ("blocks", numBlocks);
+            addResult (results, "silence", entry);
+        }
+    }
+
+    //==============================================================================
+    /**
+        Audio-rate frequency modulation. First PeakCoefficientTable on its own:
+        its accuracy against makePeak() in double (next to makePeak() rounded
+        to float, for scale), and its cost per band with 24 bands per call.
+        Then processBlock() with an LFO moving 3 or all 24 bands.
+    */
+    void runModulationBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        using Coefficients = BiquadCoefficients<double>;
+
+        PeakCoefficientTable table;
+
+        // Accuracy over normalised frequency, Q and gain. The response error is the worst over the whole band.
+        double coefficientError = 0.0, tableError = 0.0, roundedError = 0.0, lowTableError = 0.0, lowRoundedError = 0.0;
+
+        for (auto proportion = std::exp2 (-10.0); proportion < 0.49; proportion *= 1.02)
+        {
+            for (auto Q : { 0.1, 0.3, 0.707, 1.0, 2.0, 5.0, 10.0 })
+            {
+                for (auto gainDecibels : { -24.0, -12.0, -3.0, 3.0, 12.0, 24.0 })
+                {
+                    const auto gain    = juce::Decibels::decibelsToGain (gainDecibels);
+                    const auto exact   = Coefficients::makePeak (sampleRate, proportion * sampleRate, Q, gain);
+                    const auto rounded = exact.withType<float>().withType<double>();
+                    const auto fast    = table.makePeak ((float) std::log2 (proportion),
+                                                         PeakCoefficientTable::makeShape ((float) Q, (float) gain)).withType<double>();
+
+                    for (auto difference : { fast.b0 - exact.b0, fast.b1 - exact.b1, fast.b2 - exact.b2, fast.a1 - exact.a1, fast.a2 - exact.a2 })
+                        coefficientError = juce::jmax (coefficientError, std::abs (difference));
+
+                    const auto isLow = proportion < 1.0 / 256.0;
+                    auto& fastMax    = isLow ? lowTableError   : tableError;
+                    auto& roundedMax = isLow ? lowRoundedError : roundedError;
+
+                    for (auto omega = 1.0e-4; omega < juce::MathConstants<double>::pi; omega *= 1.02)
+                    {
+                        const auto reference = getMagnitudeDecibels (exact, omega);
+                        fastMax    = juce::jmax (fastMax,    std::abs (getMagnitudeDecibels (fast,    omega) - reference));
+                        roundedMax = juce::jmax (roundedMax, std::abs (getMagnitudeDecibels (rounded, omega) - reference));
+                    }
+                }
+            }
+        }
+
+        std::printf ("table:   coefficients within %.2g; response within %.3g dB above fs/256 (float makePeak %.3g dB), "
+                     "%.3g dB from fs/1024 (float makePeak %.3g dB)\n",
+                     coefficientError, tableError, roundedError, lowTableError, lowRoundedError);
+
+        results.setProperty ("tableCoefficientError", coefficientError);
+        results.setProperty ("tableResponseErrorDb", tableError);
+        results.setProperty ("tableLowResponseErrorDb", lowTableError);
+
+        // Cost: 24 bands per makePeaks() call, as ModulatedBands does every sample
+        {
+            constexpr size_t numBands = SpectralEQAudioProcessor::maxBands;
+            float octaves[numBands], A[numBands], halfInvQ[numBands];
+            float b0[numBands], b1[numBands], b2[numBands], a1[numBands], a2[numBands];
+
+            juce::Random random (11);
+
+            for (size_t k = 0; k < numBands; ++k)
+            {
+                const auto shape = PeakCoefficientTable::makeShape (0.1f + 9.9f * random.nextFloat(),
+                                                                    juce::Decibels::decibelsToGain (-24.0f + 48.0f * random.nextFloat()));
+                octaves[k]  = PeakCoefficientTable::toOctave (20.0 * std::pow (1000.0, (double) random.nextFloat()), sampleRate);
+                A[k]        = shape.A;
+                halfInvQ[k] = shape.halfInvQ;
+            }
+
+            const auto budget = (juce::int64) (secondsPerCase * (double) juce::Time::getHighResolutionTicksPerSecond());
+            const auto start  = juce::Time::getHighResolutionTicks();
+
+            juce::int64 numDesigns = 0;
+            float checksum = 0.0f;
+
+            while (juce::Time::getHighResolutionTicks() - start < budget)
+            {
+                for (int i = 0; i < 1024; ++i)
+                {
+                    // A different octave offset every call, like an LFO sample
+                    octaves[(size_t) i % numBands] += 1.0e-4f;
+                    table.makePeaks (octaves, A, halfInvQ, numBands, b0, b1, b2, a1, a2);
+                    checksum += b0[0];
+                }
+
+                numDesigns += 1024 * (juce::int64) numBands;
+            }
+
+            const auto nanosPerDesign = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start)
+                                          * 1.0e9 / (double) numDesigns;
+
+            std::printf ("coeffs:  %-20s %18.2f ns/band (checksum %g)\n", "table", nanosPerDesign, (double) checksum);
+            results.setProperty ("tableCoefficientsNsPerBand", nanosPerDesign);
+        }
+
+        // The whole plugin, with an LFO on some or all bands
+        juce::AudioBuffer<float> source (2, sourceLength);
+        fillWithNoise (source);
+
+        juce::MidiBuffer midi;
+
+        for (auto allBands : { false, true })
+        {
+            for (auto modulated : { false, true })
+            {
+                SpectralEQAudioProcessor processor;
+                processor.setAnalyserEnabled (false);
+
+                const auto numBands = allBands ? SpectralEQAudioProcessor::maxBands : (size_t) 3;
+
+                for (size_t b = 0; b < numBands; ++b)
+                {
+                    processor.apvts.getParameter (SpectralEQAudioProcessor::getBandParameterID (b, "On"))->setValueNotifyingHost (1.0f);
+                    processor.apvts.getParameter (SpectralEQAudioProcessor::getBandParameterID (b, "Mod"))->setValueNotifyingHost (1.0f);
+                }
+
+                auto* modSource = processor.apvts.getParameter ("ModSource");
+                modSource->setValueNotifyingHost (modSource->convertTo0to1 (modulated ? 1.0f : 0.0f));
+
+                processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+                processor.prepareToPlay (sampleRate, blockSize);
+
+                auto nanosPerSample = measureNanosPerSample (source, blockSize, secondsPerCase, [&] (juce::dsp::AudioBlock<float>& block)
+                {
+                    float* channels[] = { block.getChannelPointer (0), block.getChannelPointer (1) };
+                    juce::AudioBuffer<float> buffer (channels, 2, (int) block.getNumSamples());
+                    processor.processBlock (buffer, midi);
+                });
+
+                processor.releaseResources();
+
+                std::printf ("modulation: %2d bands, %-9s %10.2f ns/sample\n",
+                             (int) numBands, modulated ? "LFO" : "static", nanosPerSample);
+
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty ("enabledBands", (int) numBands);
+                entry->setProperty ("modulated", modulated);
+                entry->setProperty ("nsPerSample", nanosPerSample);
+                addResult (results, "modulation", entry);
+            }
+        }
+    }
+
+    //==============================================================================
+    /**
+        What the state timings rely on: a binary state restores every
+        parameter exactly, a damaged one changes nothing, and an XML state
+        saved before the binary format still loads. Prints each failure and
+        returns how many there were.
+    */
+    int checkStateFormats()
+    {
+        SpectralEQAudioProcessor source, dest;
+        juce::Random random (11);
+        int numFailures = 0;
+
+        auto fail = [&numFailures] (const juce::String& what)
+        {
+            std::printf ("state check FAILED: %s\n", what.toRawUTF8());
+            ++numFailures;
+        };
+
+        auto randomise = [&random] (juce::AudioProcessor& processor)
+        {
+            for (auto* param : processor.getParameters())
+                param->setValueNotifyingHost (random.nextFloat());
+        };
+
+        auto getValues = [] (juce::AudioProcessor& processor)
+        {
+            juce::Array<float> values;
+
+            for (auto* param : processor.getParameters())
+                values.add (param->getValue());
+
+            return values;
+        };
+
+        // Round trip: every parameter comes back exactly
+        randomise (source);
+        randomise (dest);
+
+        juce::MemoryBlock state;
+        source.getStateInformation (state);
+        dest.setStateInformation (state.getData(), (int) state.getSize());
+
+        const auto saved = getValues (source);
+        const auto restored = getValues (dest);
+
+        for (int i = 0; i < saved.size(); ++i)
+            if (saved[i] != restored[i])
+                fail ("round trip changed " + source.getParameters()[i]->getName (64)
+                        + " from " + juce::String (saved[i], 9) + " to " + juce::String (restored[i], 9));
+
+        // Damaged states are rejected whole
+        randomise (dest);
+        const auto before = getValues (dest);
+
+        juce::MemoryBlock corrupted (state);
+        static_cast<juce::uint8*> (corrupted.getData())[corrupted.getSize() / 2] ^= 0x10;
+        dest.setStateInformation (corrupted.getData(), (int) corrupted.getSize());
+
+        if (getValues (dest) != before)
+            fail ("a state with a bad CRC was applied");
+
+        dest.setStateInformation (state.getData(), (int) state.getSize() - 1);
+
+        if (getValues (dest) != before)
+            fail ("a truncated state was applied");
+
+        // The XML written before the binary format: three bands, nothing else
+        const std::pair<const char*, float> legacyValues[] = { { "Band1Freq", 440.0f },  { "Band1Gain",  6.5f }, { "Band1Q", 2.0f },
+                                                               { "Band2Freq", 1500.0f }, { "Band2Gain", -3.0f }, { "Band2Q", 0.5f },
+                                                               { "Band3Freq", 8000.0f }, { "Band3Gain", 12.0f }, { "Band3Q", 4.0f } };
+        juce::XmlElement legacy ("Parameters");
+
+        for (const auto& [id, value] : legacyValues)
+        {
+            auto* param = legacy.createNewChildElement ("PARAM");
+            param->setAttribute ("id", id);
+            param->setAttribute ("value", value);
+        }
+
+        juce::MemoryBlock legacyState;
+        juce::AudioProcessor::copyXmlToBinary (legacy, legacyState);
+        dest.setStateInformation (legacyState.getData(), (int) legacyState.getSize());
+
+        for (const auto& [id, value] : legacyValues)
+        {
+            auto* param = dest.apvts.getParameter (id);
+            const auto loaded = param != nullptr ? param->convertFrom0to1 (param->getValue()) : 0.0f;
+
+            if (param == nullptr || std::abs (loaded - value) > 1.0e-4f * juce::jmax (1.0f, std::abs (value)))
+                fail (juce::String ("the legacy XML state set ") + id + " to " + juce::String (loaded) + ", not " + juce::String (value));
+        }
+
+        std::printf ("state: %d check(s) failed\n", numFailures);
+        return numFailures;
+    }
+
+    //==============================================================================
+    /**
+        Saving and restoring one instance's state, as hosts do for every
+        instance on session load and constantly for snapshots and undo. The
+        binary state is compared with the XML one it replaced (ValueTree, XML
+        and copyXmlToBinary), which setStateInformation() still reads. Loads
+        alternate between two different states, so every one of them changes
+        the parameters.
+    */
+    void runStateBenchmark (double secondsPerCase, juce::DynamicObject& results)
+    {
+        SpectralEQAudioProcessor processor;
+        juce::Random random (7);
+
+        auto saveState = [&processor] (bool asXml, juce::MemoryBlock& dest)
+        {
+            if (! asXml)
+                processor.getStateInformation (dest);
+            else if (auto xml = processor.apvts.copyState().createXml())
+                juce::AudioProcessor::copyXmlToBinary (*xml, dest);
+        };
+
+        // Two random states in each format
+        juce::MemoryBlock states[2][2];
+
+        for (auto& pair : states)
+        {
+            for (auto* param : processor.getParameters())
+                param->setValueNotifyingHost (random.nextFloat());
+
+            saveState (false, pair[0]);
+            saveState (true,  pair[1]);
+        }
+
+        auto microsecondsPerCall = [secondsPerCase] (auto&& call)
+        {
+            const auto budget = (juce::int64) (secondsPerCase * (double) juce::Time::getHighResolutionTicksPerSecond());
+            const auto start  = juce::Time::getHighResolutionTicks();
+
+            juce::int64 calls = 0, ticksSpent = 0;
+
+            while (ticksSpent < budget)
+            {
+                call (calls++);
+                ticksSpent = juce::Time::getHighResolutionTicks() - start;
+            }
+
+            return juce::Time::highResolutionTicksToSeconds (ticksSpent) * 1.0e6 / (double) calls;
+        };
+
+        for (auto asXml : { false, true })
+        {
+            const auto* format = asXml ? "xml" : "binary";
+            juce::MemoryBlock block;
+
+            const auto saveMicroseconds = microsecondsPerCall ([&] (juce::int64) { saveState (asXml, block); });
+
+            const auto loadMicroseconds = microsecondsPerCall ([&] (juce::int64 call)
+            {
+                const auto& state = states[call & 1][asXml ? 1 : 0];
+                processor.setStateInformation (state.getData(), (int) state.getSize());
+            });
+
+            const auto bytes = (int) states[0][asXml ? 1 : 0].getSize();
+
+            std::printf ("state: %-6s %6d bytes, save %8.2f us, load %8.2f us\n",
+                         format, bytes, saveMicroseconds, loadMicroseconds);
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty ("format", format);
+            entry->setProperty ("bytes", bytes);
+            entry->setProperty ("saveMicroseconds", saveMicroseconds);
+            entry->setProperty ("loadMicroseconds", loadMicroseconds);
+            addResult (results, "state", entry);
+        }
+    }
+
+    //==============================================================================
+    /**
+        Creating and preparing instances, as a host does when it loads a large
+        session. The first instance builds the FFT plans, windows and tables
+        in SharedResources; every later one picks them up from there, so the
+        two are reported separately.
+    */
+    void runInstanceBenchmark (juce::DynamicObject& results)
+    {
+        constexpr int numInstances = 64;
+
+        std::vector<std::unique_ptr<SpectralEQAudioProcessor>> instances;
+        double firstMilliseconds = 0.0, restMilliseconds = 0.0;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            instances.push_back (std::make_unique<SpectralEQAudioProcessor>());
+            instances.back()->setPlayConfigDetails (2, 2, 48000.0, 512);
+            instances.back()->prepareToPlay (48000.0, 512);
+
+            const auto milliseconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1.0e3;
+            (i == 0 ? firstMilliseconds : restMilliseconds) += milliseconds;
+        }
+
+        restMilliseconds /= (double) (numInstances - 1);
+
+        for (auto& instance : instances)
+            instance->releaseResources();
+
+        std::printf ("instances: first %8.3f ms, each of the next %d %8.3f ms\n",
+                     firstMilliseconds, numInstances - 1, restMilliseconds);
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty ("numInstances", numInstances);
+        entry->setProperty ("firstMilliseconds", firstMilliseconds);
+        entry->setProperty ("laterMilliseconds", restMilliseconds);
+        addResult (results, "instances", entry);
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args (argc, argv);
+
+    const auto secondsPerCase = args.containsOption ("--seconds")
+                                  ? juce::jmax (0.01, args.getValueForOption ("--seconds").getDoubleValue())
+                                  : 0.25;
+
+    // Everything measured, by section, for --json
+    juce::DynamicObject::Ptr results = new juce::DynamicObject();
+
+    results->setProperty ("date", juce::Time::getCurrentTime().toISO8601 (true));
+    results->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    results->setProperty ("juceVersion", juce::SystemStats::getJUCEVersion());
+    results->setProperty ("simd", JUCE_USE_SIMD != 0);
+    results->setProperty ("secondsPerCase", secondsPerCase);
+
+    runCascadeBenchmark (secondsPerCase, *results);
+    runFilterBenchmark (secondsPerCase, *results);
+    runChannelBenchmark (secondsPerCase, *results);
+    runCoefficientBenchmark (secondsPerCase, *results);
+    runPeakDesignBenchmark (secondsPerCase, *results);
+    runFFTBenchmark (secondsPerCase, *results);
+    runProcessBlockBenchmark (secondsPerCase, *results);
+    runPrecisionBenchmark (secondsPerCase, *results);
+    runSilenceBenchmark (secondsPerCase, *results);
+    runModulationBenchmark (secondsPerCase, *results);
+    const auto numStateFailures = checkStateFormats();
+    runStateBenchmark (secondsPerCase, *results);
+    runInstanceBenchmark (*results);
+
+    if (args.containsOption ("--json"))
+    {
+        const auto jsonFile = args.getFileForOption ("--json");
+
+        if (! jsonFile.replaceWithText (juce::JSON::toString (juce::var (results.get()))))
+        {
+            std::fprintf (stderr, "Can't write %s\n", jsonFile.getFullPathName().toRawUTF8());
+            return 1;
+        }
+    }
+
+    return numStateFailures == 0 ? 0 : 1;
+}
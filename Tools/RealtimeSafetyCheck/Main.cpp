@@ -0,0 +1,226 @@
+/*
+    Headless real-time safety check for SpectralEQAudioProcessor.
+
+    Build this as a JUCE console application (juce_audio_processors, juce_dsp,
+    juce_audio_utils) that also compiles every .cpp file in Source/, defines
+    JucePlugin_Name, and links with -rdynamic -ldl so the stacks printed by
+    RealtimeSafety are symbolised.
+
+    It drives the processor through a grid of sample precisions, channel
+    counts, sample rates, block sizes and test signals while sweeping every parameter, between blocks
+    and from inside the real-time section (as a host's automation would),
+    playing MIDI notes, switching and morphing between presets of a bank of
+    random settings, and fails with a non-zero exit code as soon as anything
+    inside processBlock or the processor's parameter listener allocates,
+    frees, locks or sleeps. It also fails if the latency reported to the host
+    ever falls behind the settings, e.g. after a preset recall moves the
+    oversampling order.
+
+    Usage: RealtimeSafetyCheck [--keep-going]
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "RealtimeSafety.h"
+
+//==============================================================================
+namespace
+{
+    enum class Signal { silence, sine, noise, impulse };
+
+    constexpr int numPresets = 8;
+
+    template <typename SampleType>
+    void fillBuffer (juce::AudioBuffer<SampleType>& buffer, Signal signal, double sampleRate,
+                     juce::int64& position, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const auto n = position + i;
+
+                switch (signal)
+                {
+                    case Signal::silence: data[i] = (SampleType) 0; break;
+                    case Signal::sine:    data[i] = (SampleType) std::sin (juce::MathConstants<double>::twoPi * 997.0 * (double) n / sampleRate); break;
+                    case Signal::noise:   data[i] = (SampleType) (random.nextFloat() * 2.0f - 1.0f); break;
+                    case Signal::impulse: data[i] = (SampleType) ((n % 4096) == 0 ? 1 : 0); break;
+                }
+            }
+        }
+
+        position += buffer.getNumSamples();
+    }
+
+    /** Moves every parameter somewhere new, notifying the processor as a host would. */
+    void sweepParameters (juce::AudioProcessor& processor, juce::Random& random)
+    {
+        for (auto* param : processor.getParameters())
+            param->setValueNotifyingHost (random.nextFloat());
+    }
+
+    /**
+        A new note somewhere in the block, releasing the last one, for the MIDI note modulation source,
+        and now and then a program change to recall a preset.
+    */
+    void fillMidi (juce::MidiBuffer& midi, int blockSize, int& note, juce::Random& random)
+    {
+        midi.clear();
+
+        if (note >= 0)
+            midi.addEvent (juce::MidiMessage::noteOff (1, note), 0);
+
+        note = 36 + random.nextInt (48);
+        midi.addEvent (juce::MidiMessage::noteOn (1, note, 0.8f), random.nextInt (blockSize));
+
+        if (random.nextInt (4) == 0)
+            midi.addEvent (juce::MidiMessage::programChange (1, random.nextInt (numPresets)), 0);
+    }
+
+    /** Writes a bank of presets with random settings for the processors to switch between. */
+    juce::Result writePresetBank (const juce::File& file, juce::Random& random)
+    {
+        SpectralEQAudioProcessor processor;
+        juce::StringArray names;
+        juce::Array<juce::MemoryBlock> states;
+
+        for (int i = 0; i < numPresets; ++i)
+        {
+            sweepParameters (processor, random);
+            juce::MemoryBlock state;
+            processor.getStateInformation (state);
+            states.add (state);
+            names.add ("Random " + juce::String (i + 1));
+        }
+
+        return PresetBank::write (file, names, states);
+    }
+
+    /**
+        Plays every test signal through a prepared processor in SampleType
+        precision, counting the runs and any block whose latency report was stale.
+    */
+    template <typename SampleType>
+    void runSignals (SpectralEQAudioProcessor& processor, int numChannels, double sampleRate, int blockSize,
+                     juce::Random& random, int& numRuns, int& numLatencyMismatches)
+    {
+        constexpr Signal signals[]    = { Signal::silence, Signal::sine, Signal::noise, Signal::impulse };
+        constexpr int    blocksPerRun = 200;
+
+        juce::AudioBuffer<SampleType> buffer (numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        for (auto signal : signals)
+        {
+            juce::int64 position = 0;
+            int note = -1;
+
+            for (int block = 0; block < blocksPerRun; ++block)
+            {
+                // Whatever moved the latency last block, automation or a preset recall, the host must hear of it
+                processor.dispatchPendingChanges();
+
+                if (processor.getLatencySamples() != processor.getRequiredLatencySamples())
+                {
+                    if (numLatencyMismatches++ == 0)
+                        std::printf ("Reported latency %d, but the settings need %d (%s, %d channels, %.0f Hz, block %d)\n",
+                                     processor.getLatencySamples(), processor.getRequiredLatencySamples(),
+                                     processor.isUsingDoublePrecision() ? "double" : "float",
+                                     numChannels, sampleRate, blockSize);
+                }
+
+                // Automate on every fourth block, leave parameters static otherwise
+                if (block % 4 == 0)
+                    sweepParameters (processor, random);
+                else if (block % 4 == 2)
+                    processor.setPresetMorph (random.nextInt (numPresets), random.nextInt (numPresets), random.nextFloat());
+
+                fillBuffer (buffer, signal, sampleRate, position, random);
+
+                if (block % 8 == 0)
+                    fillMidi (midi, blockSize, note, random);
+                else
+                    midi.clear();
+
+                RealtimeSafety::ScopedRealtimeSection realtime;
+
+                // Now and then automate from the audio thread itself, as hosts do
+                if (block % 16 == 8)
+                    sweepParameters (processor, random);
+
+                processor.processBlock (buffer, midi);
+            }
+
+            ++numRuns;
+        }
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    juce::ArgumentList args (argc, argv);
+
+    RealtimeSafety::initialise();
+    RealtimeSafety::setAbortOnViolation (! args.containsOption ("--keep-going"));
+
+    // JUCE locks its listener lists while notifying them of automation, in every plugin;
+    // what the processor's own listener does from there is still checked
+    RealtimeSafety::allowLocksTakenBy ("sendValueChangedMessageToListeners");
+    RealtimeSafety::allowLocksTakenBy ("sendParamChangeMessageToListeners");
+
+    using Precision = juce::AudioProcessor::ProcessingPrecision;
+
+    const Precision precisions[]    = { juce::AudioProcessor::singlePrecision, juce::AudioProcessor::doublePrecision };
+    const int       channelCounts[] = { 1, 2, 12 };
+    const double    sampleRates[]   = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const int       blockSizes[]    = { 1, 32, 64, 441, 512, 4096 };
+
+    juce::Random random (1234);
+    int numRuns = 0, numLatencyMismatches = 0;
+
+    juce::TemporaryFile bankFile (".eqbank");
+
+    if (const auto written = writePresetBank (bankFile.getFile(), random); written.failed())
+    {
+        std::printf ("Can't write the preset bank: %s\n", written.getErrorMessage().toRawUTF8());
+        return 1;
+    }
+
+    for (auto precision : precisions)
+    {
+        for (auto numChannels : channelCounts)
+        {
+            for (auto sampleRate : sampleRates)
+            {
+                for (auto blockSize : blockSizes)
+                {
+                    // The double engine has oversamplers and conversions of its own, so it gets the whole grid too
+                    SpectralEQAudioProcessor processor;
+                    processor.analyser.addConsumer();
+                    processor.setProcessingPrecision (precision);
+                    processor.setPlayConfigDetails (numChannels, numChannels, sampleRate, blockSize);
+                    processor.prepareToPlay (sampleRate, blockSize);
+                    processor.loadPresetBank (bankFile.getFile());
+
+                    if (precision == juce::AudioProcessor::doublePrecision)
+                        runSignals<double> (processor, numChannels, sampleRate, blockSize, random, numRuns, numLatencyMismatches);
+                    else
+                        runSignals<float> (processor, numChannels, sampleRate, blockSize, random, numRuns, numLatencyMismatches);
+
+                    processor.releaseResources();
+                }
+            }
+        }
+    }
+
+    const auto numViolations = RealtimeSafety::getNumViolations();
+
+    std::printf ("%d runs, %d real-time safety violation(s), %d stale latency report(s)\n",
+                 numRuns, numViolations, numLatencyMismatches);
+    return numViolations == 0 && numLatencyMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+#include "RealtimeSafety.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+//==============================================================================
+namespace
+{
+    thread_local int  realtimeDepth = 0;
+    thread_local bool isReporting   = false;
+
+    std::atomic<int>  numViolations     { 0 };
+    std::atomic<bool> abortOnViolation  { true };
+
+    constexpr int maxAllowedLockers = 8;
+    const char* allowedLockers[maxAllowedLockers] = {};
+    int numAllowedLockers = 0;
+
+    /** True if the calling thread is in a section and not already busy reporting. */
+    inline bool shouldCheck() noexcept
+    {
+        return realtimeDepth > 0 && ! isReporting;
+    }
+
+    void writeString (const char* text) noexcept
+    {
+        auto len = std::strlen (text);
+
+        while (len > 0)
+        {
+            auto written = ::write (STDERR_FILENO, text, len);
+
+            if (written <= 0)
+                return;
+
+            text += written;
+            len  -= (size_t) written;
+        }
+    }
+
+    /** Prints the offending call and stack. Everything in here may itself allocate. */
+    void reportViolation (const char* function) noexcept
+    {
+        isReporting = true;
+
+        numViolations.fetch_add (1);
+
+        writeString ("\n*** Real-time safety violation: ");
+        writeString (function);
+        writeString ("() called inside a real-time section\n");
+
+        void* frames[64];
+        auto numFrames = ::backtrace (frames, 64);
+
+        // Skip this function and the interposer that called it
+        if (numFrames > 2)
+            ::backtrace_symbols_fd (frames + 2, numFrames - 2, STDERR_FILENO);
+
+        writeString ("\n");
+
+        if (abortOnViolation.load())
+            std::abort();
+
+        isReporting = false;
+    }
+
+    /**
+        True if the mutex being locked is taken by one of the allowedLockers. The
+        stack is, from the top: this function, the interposer, any JUCE lock
+        wrappers or unnamed helpers, then the function taking the lock.
+    */
+    __attribute__ ((noinline)) bool isAllowedLock() noexcept
+    {
+        if (numAllowedLockers == 0)
+            return false;
+
+        isReporting = true;
+
+        void* frames[8];
+        const auto numFrames = ::backtrace (frames, 8);
+        auto allowed = false;
+
+        for (int i = 2; i < numFrames; ++i)
+        {
+            Dl_info info;
+
+            // Unnamed frames are local helpers, like inlined lock wrappers
+            if (::dladdr (frames[i], &info) == 0 || info.dli_sname == nullptr)
+                continue;
+
+            if (std::strstr (info.dli_sname, "CriticalSection") != nullptr
+                 || std::strstr (info.dli_sname, "GenericScopedLock") != nullptr)
+                continue;
+
+            for (int n = 0; n < numAllowedLockers; ++n)
+                allowed = allowed || std::strstr (info.dli_sname, allowedLockers[n]) != nullptr;
+
+            break;
+        }
+
+        isReporting = false;
+        return allowed;
+    }
+
+    //==============================================================================
+    /** Looks up the next definition of a symbol (i.e. the libc / libpthread one). */
+    template <typename FunctionType>
+    FunctionType resolveNext (FunctionType& cached, const char* name) noexcept
+    {
+        if (cached == nullptr)
+            cached = reinterpret_cast<FunctionType> (::dlsym (RTLD_NEXT, name));
+
+        return cached;
+    }
+
+    int (*realMutexLock)       (pthread_mutex_t*)                                      = nullptr;
+    int (*realCondWait)        (pthread_cond_t*, pthread_mutex_t*)                     = nullptr;
+    int (*realCondTimedWait)   (pthread_cond_t*, pthread_mutex_t*, const timespec*)    = nullptr;
+    int (*realRwlockRdlock)    (pthread_rwlock_t*)                                     = nullptr;
+    int (*realRwlockWrlock)    (pthread_rwlock_t*)                                     = nullptr;
+    int (*realJoin)            (pthread_t, void**)                                     = nullptr;
+    int (*realSemWait)         (sem_t*)                                                = nullptr;
+    int (*realNanosleep)       (const timespec*, timespec*)                            = nullptr;
+    int (*realClockNanosleep)  (clockid_t, int, const timespec*, timespec*)            = nullptr;
+    int (*realUsleep)          (useconds_t)                                            = nullptr;
+}
+
+// glibc's own allocator entry points, used to forward without going through dlsym
+extern "C"
+{
+    void* __libc_malloc   (size_t);
+    void* __libc_calloc   (size_t, size_t);
+    void* __libc_realloc  (void*, size_t);
+    void  __libc_free     (void*);
+    void* __libc_memalign (size_t, size_t);
+}
+
+//==============================================================================
+RealtimeSafety::ScopedRealtimeSection::ScopedRealtimeSection() noexcept   { ++realtimeDepth; }
+RealtimeSafety::ScopedRealtimeSection::~ScopedRealtimeSection() noexcept  { --realtimeDepth; }
+
+int RealtimeSafety::getNumViolations() noexcept
+{
+    return numViolations.load();
+}
+
+void RealtimeSafety::setAbortOnViolation (bool shouldAbort) noexcept
+{
+    abortOnViolation.store (shouldAbort);
+}
+
+void RealtimeSafety::allowLocksTakenBy (const char* name)
+{
+    if (numAllowedLockers < maxAllowedLockers)
+        allowedLockers[numAllowedLockers++] = name;
+}
+
+void RealtimeSafety::initialise()
+{
+    resolveNext (realMutexLock,      "pthread_mutex_lock");
+    resolveNext (realCondWait,       "pthread_cond_wait");
+    resolveNext (realCondTimedWait,  "pthread_cond_timedwait");
+    resolveNext (realRwlockRdlock,   "pthread_rwlock_rdlock");
+    resolveNext (realRwlockWrlock,   "pthread_rwlock_wrlock");
+    resolveNext (realJoin,           "pthread_join");
+    resolveNext (realSemWait,        "sem_wait");
+    resolveNext (realNanosleep,      "nanosleep");
+    resolveNext (realClockNanosleep, "clock_nanosleep");
+    resolveNext (realUsleep,         "usleep");
+
+    // The first backtrace() call loads libgcc_s, which allocates
+    void* frames[4];
+    ::backtrace (frames, 4);
+}
+
+//==============================================================================
+// Allocator interposers
+extern "C"
+{
+    void* malloc (size_t size)
+    {
+        if (shouldCheck())
+            reportViolation ("malloc");
+
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t num, size_t size)
+    {
+        if (shouldCheck())
+            reportViolation ("calloc");
+
+        return __libc_calloc (num, size);
+    }
+
+    void* realloc (void* ptr, size_t size)
+    {
+        if (shouldCheck())
+            reportViolation ("realloc");
+
+        return __libc_realloc (ptr, size);
+    }
+
+    void free (void* ptr)
+    {
+        if (ptr != nullptr && shouldCheck())
+            reportViolation ("free");
+
+        __libc_free (ptr);
+    }
+
+    void* memalign (size_t alignment, size_t size)
+    {
+        if (shouldCheck())
+            reportViolation ("memalign");
+
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size)
+    {
+        if (shouldCheck())
+            reportViolation ("aligned_alloc");
+
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size)
+    {
+        if (shouldCheck())
+            reportViolation ("posix_memalign");
+
+        auto* ptr = __libc_memalign (alignment, size);
+
+        if (ptr == nullptr)
+            return ENOMEM;
+
+        *result = ptr;
+        return 0;
+    }
+
+    //==============================================================================
+    // Locks and blocking calls
+    int pthread_mutex_lock (pthread_mutex_t* mutex)
+    {
+        if (shouldCheck() && ! isAllowedLock())
+            reportViolation ("pthread_mutex_lock");
+
+        return resolveNext (realMutexLock, "pthread_mutex_lock") (mutex);
+    }
+
+    int pthread_cond_wait (pthread_cond_t* cond, pthread_mutex_t* mutex)
+    {
+        if (shouldCheck())
+            reportViolation ("pthread_cond_wait");
+
+        return resolveNext (realCondWait, "pthread_cond_wait") (cond, mutex);
+    }
+
+    int pthread_cond_timedwait (pthread_cond_t* cond, pthread_mutex_t* mutex, const timespec* time)
+    {
+        if (shouldCheck())
+            reportViolation ("pthread_cond_timedwait");
+
+        return resolveNext (realCondTimedWait, "pthread_cond_timedwait") (cond, mutex, time);
+    }
+
+    int pthread_rwlock_rdlock (pthread_rwlock_t* lock)
+    {
+        if (shouldCheck())
+            reportViolation ("pthread_rwlock_rdlock");
+
+        return resolveNext (realRwlockRdlock, "pthread_rwlock_rdlock") (lock);
+    }
+
+    int pthread_rwlock_wrlock (pthread_rwlock_t* lock)
+    {
+        if (shouldCheck())
+            reportViolation ("pthread_rwlock_wrlock");
+
+        return resolveNext (realRwlockWrlock, "pthread_rwlock_wrlock") (lock);
+    }
+
+    int pthread_join (pthread_t thread, void** result)
+    {
+        if (shouldCheck())
+            reportViolation ("pthread_join");
+
+        return resolveNext (realJoin, "pthread_join") (thread, result);
+    }
+
+    int sem_wait (sem_t* semaphore)
+    {
+        if (shouldCheck())
+            reportViolation ("sem_wait");
+
+        return resolveNext (realSemWait, "sem_wait") (semaphore);
+    }
+
+    int nanosleep (const timespec* duration, timespec* remaining)
+    {
+        if (shouldCheck())
+            reportViolation ("nanosleep");
+
+        return resolveNext (realNanosleep, "nanosleep") (duration, remaining);
+    }
+
+    int clock_nanosleep (clockid_t clock, int flags, const timespec* time, timespec* remaining)
+    {
+        if (shouldCheck())
+            reportViolation ("clock_nanosleep");
+
+        return resolveNext (realClockNanosleep, "clock_nanosleep") (clock, flags, time, remaining);
+    }
+
+    int usleep (useconds_t microseconds)
+    {
+        if (shouldCheck())
+            reportViolation ("usleep");
+
+        return resolveNext (realUsleep, "usleep") (microseconds);
+    }
+}
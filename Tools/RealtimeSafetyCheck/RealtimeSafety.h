@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+
+//==============================================================================
+/**
+    Detects real-time safety violations on threads that are currently inside a
+    ScopedRealtimeSection.
+
+    RealtimeSafety.cpp interposes the C allocator (malloc, calloc, realloc, free,
+    posix_memalign, ...), pthread mutex / condition variable / rwlock calls and
+    the common sleep functions. When any of them is hit from inside a section,
+    the call is reported on stderr together with its call stack, and (by
+    default) the process aborts.
+
+    Interposition only works for code linked into the same executable, so this
+    is meant for headless harnesses like this tool rather than for plugin builds
+    loaded by a host. Linux / glibc only.
+*/
+class RealtimeSafety
+{
+public:
+    //==============================================================================
+    /** Marks the calling thread as real-time for the lifetime of this object. */
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection() noexcept;
+        ~ScopedRealtimeSection() noexcept;
+    };
+
+    //==============================================================================
+    /** Total number of violations seen so far, across all threads. */
+    static int getNumViolations() noexcept;
+
+    /** If true (the default) the first violation aborts the process after reporting it. */
+    static void setAbortOnViolation (bool shouldAbort) noexcept;
+
+    /**
+        Ignores pthread mutex locks taken directly (or through juce::CriticalSection)
+        by a function whose symbol contains name. This is meant for locks the
+        framework itself takes on the host's side of a call, like JUCE's
+        parameter listener locks, which every JUCE plugin takes when automated.
+        Anything those functions call into is still checked. Needs -rdynamic.
+        Call before entering the first section.
+    */
+    static void allowLocksTakenBy (const char* name);
+
+    /**
+        Resolves the real symbols and primes the unwinder. Call this once before
+        entering the first section so that lazy initialisation inside the checker
+        itself doesn't show up as a violation.
+    */
+    static void initialise();
+};